@@ -0,0 +1,87 @@
+//
+//  acknowledged_counter_generator.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_ACKNOWLEDGED_COUNTER_GENERATOR_H_
+#define YCSB_C_ACKNOWLEDGED_COUNTER_GENERATOR_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "counter_generator.h"
+
+namespace ycsbc {
+
+///
+/// A counter whose Last() is the highest value below which all values handed
+/// out have been acknowledged, like the one of Java YCSB. Inserts acknowledge
+/// their key once written, so reads drawing keys up to Last() only hit
+/// records that exist.
+///
+/// Acknowledged values are marked in a sliding window of flags. Whichever
+/// thread acknowledges first advances Last() over the marked values, while
+/// the others return at once. A thread waits only if its value is a whole
+/// window ahead of the oldest one still in flight, until that one is done.
+///
+class AcknowledgedCounterGenerator : public CounterGenerator {
+ public:
+  static const uint64_t kWindowSize = 1 << 20;
+
+  AcknowledgedCounterGenerator(uint64_t start)
+      : CounterGenerator(start),
+        window_(new std::atomic<bool>[kWindowSize]),
+        limit_(start - 1) {
+    for (uint64_t i = 0; i < kWindowSize; ++i) {
+      window_[i].store(false, std::memory_order_relaxed);
+    }
+    advancing_.clear();
+  }
+
+  uint64_t Last() { return limit_.load(std::memory_order_acquire); }
+  void Set(uint64_t start) {
+    CounterGenerator::Set(start);
+    limit_.store(start - 1, std::memory_order_release);
+  }
+
+  ///
+  /// Marks a value handed out by Next() as done. Every value handed out must
+  /// be acknowledged, or acknowledging later ones may wait forever.
+  ///
+  void Acknowledge(uint64_t value);
+
+ private:
+  static const uint64_t kWindowMask = kWindowSize - 1;
+
+  std::unique_ptr<std::atomic<bool>[]> window_;
+  std::atomic<uint64_t> limit_;
+  std::atomic_flag advancing_;
+};
+
+inline void AcknowledgedCounterGenerator::Acknowledge(uint64_t value) {
+  // Its flag is still in use by the value a window before it
+  while (value > limit_.load(std::memory_order_acquire) + kWindowSize) {
+    std::this_thread::yield();
+  }
+  window_[value & kWindowMask].store(true);
+  // Sequentially consistent, so that either the advancing thread sees the
+  // flag stored above when it checks again, or this thread gets to advance
+  do {
+    if (advancing_.test_and_set()) return;
+    uint64_t limit = limit_.load(std::memory_order_relaxed);
+    while (window_[(limit + 1) & kWindowMask].load()) {
+      window_[(limit + 1) & kWindowMask].store(false,
+                                                std::memory_order_relaxed);
+      ++limit;
+    }
+    limit_.store(limit, std::memory_order_release);
+    advancing_.clear();
+  } while (window_[(limit_.load(std::memory_order_relaxed) + 1) & kWindowMask]
+               .load());
+}
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_ACKNOWLEDGED_COUNTER_GENERATOR_H_
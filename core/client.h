@@ -9,20 +9,81 @@
 #ifndef YCSB_C_CLIENT_H_
 #define YCSB_C_CLIENT_H_
 
+#include <algorithm>
 #include <string>
 
 #include "core_workload.h"
 #include "db.h"
+#include "measurements.h"
+#include "timer.h"
+#include "trace_workload.h"
 #include "utils.h"
 
 namespace ycsbc {
 
 class Client {
  public:
-  Client(DB &db, CoreWorkload &wl) : db_(db), workload_(wl) {}
+  ///
+  /// Records checked in verify mode, and how many of them failed.
+  ///
+  struct VerifyCounts {
+    VerifyCounts() : records(0), corrupted(0), stale(0) {}
+
+    uint64_t records;
+    uint64_t corrupted;  /// Bad checksum, or the value of another key
+    uint64_t stale;      /// Older than a write acknowledged before the read
+  };
+
+  ///
+  /// Outcomes of multi-key transactions. Each attempt either commits, fails
+  /// with a conflict, or fails otherwise.
+  ///
+  struct TransactionCounts {
+    TransactionCounts()
+        : transactions(0), committed(0), conflicts(0), aborted(0), retries(0) {}
+
+    uint64_t transactions;
+    uint64_t committed;
+    uint64_t conflicts;  /// Attempts aborted by a conflict
+    uint64_t aborted;    /// Given up on after the last retry
+    uint64_t retries;
+  };
+
+  Client(DB &db, CoreWorkload &wl, Measurements *measurements = NULL,
+         Measurements *intended_measurements = NULL)
+      : db_(db),
+        tables_(wl),
+        workload_(&wl),
+        measurements_(measurements),
+        intended_measurements_(intended_measurements),
+        intended_start_ns_(0) {}
+
+  ///
+  /// In target-rate mode, sets the time the next operation was scheduled to
+  /// start. Its latency is then also recorded from that time, so that delays
+  /// spent queueing behind slow operations are not omitted.
+  ///
+  void SetIntendedStart(uint64_t ns) { intended_start_ns_ = ns; }
 
   virtual bool DoInsert();
   virtual bool DoTransaction();
+  ///
+  /// Executes a pre-generated operation instead of drawing one from the
+  /// workload. The keys of multi-key transactions and batched reads are not
+  /// recorded and are drawn from the workload as they run.
+  ///
+  virtual bool DoOperation(const OpRecord &record);
+  ///
+  /// Executes an operation of a recorded trace. Values written are a single
+  /// field of the recorded size, and reads fetch all fields. All operations
+  /// go to the first table.
+  ///
+  virtual bool DoTraceOperation(const TraceRecord &record);
+
+  const VerifyCounts &verify_counts() const { return verify_counts_; }
+  const TransactionCounts &transaction_counts() const {
+    return transaction_counts_;
+  }
 
   virtual ~Client() {}
 
@@ -32,21 +93,122 @@ class Client {
   virtual int TransactionScan();
   virtual int TransactionUpdate();
   virtual int TransactionInsert();
+  virtual int TransactionDelete();
+  virtual int TransactionMultiKey();
+  virtual int TransactionBatchRead();
+
+  ///
+  /// Records the latency of an operation whose DB calls started at start_ns.
+  ///
+  void Measure(Operation op, uint64_t start_ns) {
+    uint64_t now = utils::NowNanos();
+    if (measurements_) measurements_->Record(op, now - start_ns);
+    if (intended_measurements_ && intended_start_ns_) {
+      intended_measurements_->Record(op, now - intended_start_ns_);
+    }
+  }
+
+  ///
+  /// The names of the fields to read, or NULL for all of them.
+  ///
+  const std::vector<std::string> *ReadFields(uint64_t field) {
+    if (workload_->read_all_fields()) return NULL;
+    read_fields_.resize(1);
+    read_fields_[0] = workload_->FieldName(field);
+    return &read_fields_;
+  }
+
+  ///
+  /// In verify mode, checks the fields of a record read. The key is NULL if
+  /// unknown, as for scans, and expected is the version expected before the
+  /// read started, or 0 if not all fields were read.
+  ///
+  template <typename Fields>
+  void VerifyRecord(const std::string *key, const Fields &fields,
+                    uint32_t expected);
+  ///
+  /// Same as above for a record read through the slice-based API, which
+  /// counts as corrupted if the DB could not decode it.
+  ///
+  void VerifyRecord(const std::string *key, const RecordBuffer &record,
+                    uint32_t expected);
 
   DB &db_;
-  CoreWorkload &workload_;
+  CoreWorkload &tables_;
+  CoreWorkload *workload_;  /// Workload of the table of the operation
+  Measurements *measurements_;
+  Measurements *intended_measurements_;
+  uint64_t intended_start_ns_;
+  std::string key_;  /// Reused for the key of every operation
+  ValueBuffer values_;  /// Reused for the values written
+  std::vector<std::string> read_fields_;
+  RecordBuffer record_;  /// Reused for the record read
+  ScanBuffer scan_;      /// Reused for the records scanned
+  std::vector<std::string> txn_keys_;  /// Reused by multi-key transactions
+  std::vector<uint64_t> txn_key_nums_;
+  std::vector<ValueBuffer> txn_values_;
+  ScanBuffer txn_results_;
+  std::vector<uint32_t> txn_expected_;
+  std::vector<uint64_t> txn_tickets_;
+  std::vector<std::string> batch_keys_;  /// Reused by batched reads
+  std::vector<Slice> batch_key_slices_;
+  std::vector<uint32_t> batch_expected_;
+  VerifyCounts verify_counts_;
+  TransactionCounts transaction_counts_;
 };
 
+template <typename Fields>
+inline void Client::VerifyRecord(const std::string *key, const Fields &fields,
+                                 uint32_t expected) {
+  if (!workload_->verify() || fields.empty()) return;
+  bool corrupted = false;
+  bool stale = expected != 0;  // Unless a field is as new as expected
+  for (const auto &field : fields) {
+    uint32_t seed = key ? ValueSeed(*key, field.first) : 0;
+    uint32_t version;
+    if (!CheckValue(key ? &seed : NULL, field.second, &version)) {
+      corrupted = true;
+    } else if (!VersionTable::IsOlder(version, expected)) {
+      stale = false;
+    }
+  }
+  ++verify_counts_.records;
+  if (corrupted) {
+    ++verify_counts_.corrupted;
+  } else if (stale) {
+    ++verify_counts_.stale;
+  }
+}
+
+inline void Client::VerifyRecord(const std::string *key,
+                                 const RecordBuffer &record,
+                                 uint32_t expected) {
+  if (workload_->verify() && record.corrupted()) {
+    ++verify_counts_.records;
+    ++verify_counts_.corrupted;
+    return;
+  }
+  VerifyRecord(key, record.fields(), expected);
+}
+
 inline bool Client::DoInsert() {
-  std::string key = workload_.NextSequenceKey();
-  std::vector<DB::KVPair> pairs;
-  workload_.BuildValues(pairs);
-  return (db_.Insert(workload_.NextTable(), key, pairs) == DB::kOK);
+  workload_ = &tables_.NextLoadWorkload();
+  uint64_t key_num = workload_->NextSequenceKey(&key_);
+  const std::string &key = key_;
+  workload_->BuildValues(values_);
+  uint64_t ticket = workload_->StampValues(key_num, key, values_);
+  const std::string &table = workload_->NextTable();
+  uint64_t start = utils::NowNanos();
+  int status = db_.Insert(table, key, values_.fields());
+  Measure(INSERT, start);
+  workload_->AcknowledgeWrite(key_num, ticket, status == DB::kOK);
+  return (status == DB::kOK);
 }
 
 inline bool Client::DoTransaction() {
+  workload_ = &tables_.NextTableWorkload();
   int status = -1;
-  switch (workload_.NextOperation()) {
+  switch (workload_->NextOperation()) {
     case READ:
       status = TransactionRead();
       break;
@@ -62,6 +224,15 @@ inline bool Client::DoTransaction() {
     case READMODIFYWRITE:
       status = TransactionReadModifyWrite();
       break;
+    case DELETE:
+      status = TransactionDelete();
+      break;
+    case TRANSACTION:
+      status = TransactionMultiKey();
+      break;
+    case BATCHREAD:
+      status = TransactionBatchRead();
+      break;
     default:
       throw utils::Exception("Operation request is not recognized!");
   }
@@ -69,73 +240,315 @@ inline bool Client::DoTransaction() {
   return (status == DB::kOK);
 }
 
+inline bool Client::DoOperation(const OpRecord &record) {
+  workload_ = &tables_.TableWorkload(record.table);
+  if (record.op == TRANSACTION) return TransactionMultiKey() == DB::kOK;
+  if (record.op == BATCHREAD) return TransactionBatchRead() == DB::kOK;
+  const std::string &table = workload_->NextTable();
+  workload_->BuildKeyName(record.key, &key_);
+  const std::string &key = key_;
+  const std::vector<std::string> *read_fields = ReadFields(record.field);
+  ValueBuffer &values = values_;
+  if (record.op == UPDATE || record.op == READMODIFYWRITE) {
+    if (workload_->write_all_fields()) {
+      workload_->BuildValues(values, record.field_count,
+                             record.value_length);
+    } else {
+      workload_->BuildUpdate(values, record.field, record.value_length);
+    }
+  } else if (record.op == INSERT) {
+    workload_->BuildValues(values, record.field_count, record.value_length);
+  }
+  uint64_t ticket = 0;
+  if (record.op == UPDATE || record.op == READMODIFYWRITE ||
+      record.op == INSERT) {
+    ticket = workload_->StampValues(record.key, key, values);
+  }
+  uint32_t expected =
+      read_fields ? 0 : workload_->ExpectedVersion(record.key);
+
+  int status = -1;
+  record_.Clear();
+  scan_.Clear();
+  uint64_t start = utils::NowNanos();
+  switch (record.op) {
+    case READ:
+      status = db_.Read(table, key, read_fields, &record_);
+      break;
+    case UPDATE:
+      status = db_.Update(table, key, values.fields());
+      break;
+    case INSERT:
+      status = db_.Insert(table, key, values.fields());
+      break;
+    case SCAN:
+      status = db_.Scan(table, key, record.scan_length, read_fields, &scan_);
+      break;
+    case READMODIFYWRITE:
+      db_.Read(table, key, read_fields, &record_);
+      status = db_.Update(table, key, values.fields());
+      break;
+    case DELETE:
+      status = db_.Delete(table, key);
+      break;
+    default:
+      throw utils::Exception("Operation request is not recognized!");
+  }
+  Measure(static_cast<Operation>(record.op), start);
+  VerifyRecord(&key, record_, expected);
+  for (size_t i = 0; i < scan_.size(); ++i) {
+    VerifyRecord(NULL, scan_[i], 0);
+  }
+  workload_->AcknowledgeWrite(record.key, ticket, status == DB::kOK);
+  assert(status >= 0);
+  return (status == DB::kOK);
+}
+
+inline bool Client::DoTraceOperation(const TraceRecord &record) {
+  workload_ = &tables_.TableWorkload(0);
+  const std::string &table = workload_->NextTable();
+  ValueBuffer &values = values_;
+  if (record.op == UPDATE || record.op == INSERT ||
+      record.op == READMODIFYWRITE) {
+    workload_->BuildUpdate(values, 0, record.value_size);
+    workload_->StampValues(record.key, values);
+  }
+
+  int status = -1;
+  record_.Clear();
+  scan_.Clear();
+  uint64_t start = utils::NowNanos();
+  switch (record.op) {
+    case READ:
+      status = db_.Read(table, record.key, NULL, &record_);
+      break;
+    case UPDATE:
+      status = db_.Update(table, record.key, values.fields());
+      break;
+    case INSERT:
+      status = db_.Insert(table, record.key, values.fields());
+      break;
+    case SCAN:
+      status = db_.Scan(table, record.key, record.value_size, NULL, &scan_);
+      break;
+    case READMODIFYWRITE:
+      db_.Read(table, record.key, NULL, &record_);
+      status = db_.Update(table, record.key, values.fields());
+      break;
+    case DELETE:
+      status = db_.Delete(table, record.key);
+      break;
+    default:
+      throw utils::Exception("Operation request is not recognized!");
+  }
+  Measure(record.op, start);
+  VerifyRecord(&record.key, record_, 0);
+  for (size_t i = 0; i < scan_.size(); ++i) {
+    VerifyRecord(NULL, scan_[i], 0);
+  }
+  assert(status >= 0);
+  return (status == DB::kOK);
+}
+
 inline int Client::TransactionRead() {
-  const std::string &table = workload_.NextTable();
-  const std::string &key = workload_.NextTransactionKey();
-  std::vector<DB::KVPair> result;
-  if (!workload_.read_all_fields()) {
-    std::vector<std::string> fields;
-    fields.push_back("field" + workload_.NextFieldName());
-    return db_.Read(table, key, &fields, result);
+  const std::string &table = workload_->NextTable();
+  uint64_t key_num = workload_->NextReadKey(&key_);
+  const std::string &key = key_;
+  int status;
+  if (!workload_->read_all_fields()) {
+    read_fields_.assign(1, workload_->NextFieldName());
+    uint64_t start = utils::NowNanos();
+    status = db_.Read(table, key, &read_fields_, &record_);
+    Measure(READ, start);
+    VerifyRecord(&key, record_, 0);
   } else {
-    return db_.Read(table, key, NULL, result);
+    uint32_t expected = workload_->ExpectedVersion(key_num);
+    uint64_t start = utils::NowNanos();
+    status = db_.Read(table, key, NULL, &record_);
+    Measure(READ, start);
+    VerifyRecord(&key, record_, expected);
   }
+  return status;
 }
 
 inline int Client::TransactionReadModifyWrite() {
-  const std::string &table = workload_.NextTable();
-  const std::string &key = workload_.NextTransactionKey();
-  std::vector<DB::KVPair> result;
-
-  if (!workload_.read_all_fields()) {
-    std::vector<std::string> fields;
-    fields.push_back("field" + workload_.NextFieldName());
-    db_.Read(table, key, &fields, result);
-  } else {
-    db_.Read(table, key, NULL, result);
+  const std::string &table = workload_->NextTable();
+  uint64_t key_num = workload_->NextTransactionKey(&key_);
+  const std::string &key = key_;
+  const std::vector<std::string> *read_fields = NULL;
+  if (!workload_->read_all_fields()) {
+    read_fields_.assign(1, workload_->NextFieldName());
+    read_fields = &read_fields_;
   }
 
-  std::vector<DB::KVPair> values;
-  if (workload_.write_all_fields()) {
-    workload_.BuildValues(values);
+  ValueBuffer &values = values_;
+  if (workload_->write_all_fields()) {
+    workload_->BuildValues(values);
   } else {
-    workload_.BuildUpdate(values);
+    workload_->BuildUpdate(values);
   }
-  return db_.Update(table, key, values);
+  uint32_t expected = workload_->read_all_fields()
+                          ? workload_->ExpectedVersion(key_num)
+                          : 0;
+  uint64_t ticket = workload_->StampValues(key_num, key, values);
+
+  uint64_t start = utils::NowNanos();
+  db_.Read(table, key, read_fields, &record_);
+  int status = db_.Update(table, key, values.fields());
+  Measure(READMODIFYWRITE, start);
+  VerifyRecord(&key, record_, expected);
+  if (status == DB::kOK) workload_->RecordWrite(key_num);
+  workload_->AcknowledgeWrite(key_num, ticket, status == DB::kOK);
+  return status;
 }
 
 inline int Client::TransactionScan() {
-  const std::string &table = workload_.NextTable();
-  const std::string &key = workload_.NextTransactionKey();
-  int len = workload_.NextScanLength();
-  std::vector<std::vector<DB::KVPair>> result;
-  if (!workload_.read_all_fields()) {
-    std::vector<std::string> fields;
-    fields.push_back("field" + workload_.NextFieldName());
-    return db_.Scan(table, key, len, &fields, result);
+  const std::string &table = workload_->NextTable();
+  workload_->NextReadKey(&key_);
+  const std::string &key = key_;
+  int len = workload_->NextScanLength();
+  int status;
+  if (!workload_->read_all_fields()) {
+    read_fields_.assign(1, workload_->NextFieldName());
+    uint64_t start = utils::NowNanos();
+    status = db_.Scan(table, key, len, &read_fields_, &scan_);
+    Measure(SCAN, start);
   } else {
-    return db_.Scan(table, key, len, NULL, result);
+    uint64_t start = utils::NowNanos();
+    status = db_.Scan(table, key, len, NULL, &scan_);
+    Measure(SCAN, start);
+  }
+  for (size_t i = 0; i < scan_.size(); ++i) {
+    VerifyRecord(NULL, scan_[i], 0);
   }
+  return status;
 }
 
 inline int Client::TransactionUpdate() {
-  const std::string &table = workload_.NextTable();
-  const std::string &key = workload_.NextTransactionKey();
-  std::vector<DB::KVPair> values;
-  if (workload_.write_all_fields()) {
-    workload_.BuildValues(values);
+  const std::string &table = workload_->NextTable();
+  uint64_t key_num = workload_->NextTransactionKey(&key_);
+  const std::string &key = key_;
+  ValueBuffer &values = values_;
+  if (workload_->write_all_fields()) {
+    workload_->BuildValues(values);
   } else {
-    workload_.BuildUpdate(values);
+    workload_->BuildUpdate(values);
   }
-  return db_.Update(table, key, values);
+  uint64_t ticket = workload_->StampValues(key_num, key, values);
+  uint64_t start = utils::NowNanos();
+  int status = db_.Update(table, key, values.fields());
+  Measure(UPDATE, start);
+  if (status == DB::kOK) workload_->RecordWrite(key_num);
+  workload_->AcknowledgeWrite(key_num, ticket, status == DB::kOK);
+  return status;
 }
 
 inline int Client::TransactionInsert() {
-  const std::string &table = workload_.NextTable();
-  const std::string &key = workload_.NextSequenceKey();
-  std::vector<DB::KVPair> values;
-  workload_.BuildValues(values);
-  return db_.Insert(table, key, values);
+  const std::string &table = workload_->NextTable();
+  uint64_t key_num = workload_->NextInsertKey(&key_);
+  const std::string &key = key_;
+  ValueBuffer &values = values_;
+  workload_->BuildValues(values);
+  uint64_t ticket = workload_->StampValues(key_num, key, values);
+  uint64_t start = utils::NowNanos();
+  int status = db_.Insert(table, key, values.fields());
+  Measure(INSERT, start);
+  workload_->AcknowledgeWrite(key_num, ticket, status == DB::kOK);
+  workload_->AcknowledgeInsert(key_num);
+  return status;
+}
+
+inline int Client::TransactionDelete() {
+  const std::string &table = workload_->NextTable();
+  uint64_t key_num = workload_->NextTransactionKey(&key_);
+  const std::string &key = key_;
+  uint64_t start = utils::NowNanos();
+  int status = db_.Delete(table, key);
+  Measure(DELETE, start);
+  if (status == DB::kOK) workload_->RecordDelete(key_num);
+  return status;
+}
+
+inline int Client::TransactionBatchRead() {
+  const std::string &table = workload_->NextTable();
+  size_t batch_size = workload_->batch_size();
+  batch_keys_.resize(batch_size);
+  batch_key_slices_.resize(batch_size);
+  batch_expected_.assign(batch_size, 0);
+  for (size_t i = 0; i < batch_size; ++i) {
+    uint64_t key_num = workload_->NextReadKey(&batch_keys_[i]);
+    batch_key_slices_[i] = batch_keys_[i];
+    if (workload_->read_all_fields()) {
+      batch_expected_[i] = workload_->ExpectedVersion(key_num);
+    }
+  }
+  const std::vector<std::string> *read_fields = NULL;
+  if (!workload_->read_all_fields()) {
+    read_fields_.assign(1, workload_->NextFieldName());
+    read_fields = &read_fields_;
+  }
+
+  uint64_t start = utils::NowNanos();
+  int status = db_.MultiRead(table, batch_key_slices_, read_fields, &scan_);
+  Measure(BATCHREAD, start);
+  for (size_t i = 0; i < scan_.size() && i < batch_size; ++i) {
+    VerifyRecord(&batch_keys_[i], scan_[i], batch_expected_[i]);
+  }
+  return status;
+}
+
+inline int Client::TransactionMultiKey() {
+  const std::string &table = workload_->NextTable();
+  std::vector<std::string> &keys = txn_keys_;
+  std::vector<uint64_t> &key_nums = txn_key_nums_;
+  workload_->NextTransactionKeys(&keys, &key_nums);
+  std::vector<ValueBuffer> &values = txn_values_;
+  values.resize(keys.size());
+  for (auto &record_values : values) {
+    if (workload_->write_all_fields()) {
+      workload_->BuildValues(record_values);
+    } else {
+      workload_->BuildUpdate(record_values);
+    }
+  }
+  std::vector<uint32_t> &expected = txn_expected_;
+  expected.resize(keys.size());
+  std::vector<uint64_t> &tickets = txn_tickets_;
+  tickets.resize(keys.size());
+  ++transaction_counts_.transactions;
+
+  int status;
+  uint64_t commit_ns = 0;
+  uint64_t start = utils::NowNanos();
+  for (int attempt = 0;; ++attempt) {
+    // Every attempt is a write of its own to verify mode
+    for (size_t i = 0; i < keys.size(); ++i) {
+      expected[i] = workload_->ExpectedVersion(key_nums[i]);
+      tickets[i] = workload_->StampValues(key_nums[i], keys[i], values[i]);
+    }
+    status = db_.Transaction(table, keys, values, &txn_results_, &commit_ns);
+    for (size_t i = 0; i < keys.size(); ++i) {
+      workload_->AcknowledgeWrite(key_nums[i], tickets[i],
+                                  status == DB::kOK);
+    }
+    if (status != DB::kErrorConflict) break;
+    ++transaction_counts_.conflicts;
+    if (attempt >= workload_->transaction_retries()) {
+      ++transaction_counts_.aborted;
+      break;
+    }
+    ++transaction_counts_.retries;
+  }
+  Measure(TRANSACTION, start);
+  if (status != DB::kOK) return status;
+
+  ++transaction_counts_.committed;
+  if (measurements_) measurements_->Record(COMMIT, commit_ns);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    VerifyRecord(&keys[i], txn_results_[i], expected[i]);
+    workload_->RecordWrite(key_nums[i]);
+  }
+  return status;
 }
 
 }  // namespace ycsbc
@@ -0,0 +1,133 @@
+//
+//  concurrent_bitmap.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_CONCURRENT_BITMAP_H_
+#define YCSB_C_CONCURRENT_BITMAP_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace ycsbc {
+
+///
+/// A fixed-size set of integers, one bit each, that any number of threads
+/// may update and query at once without locking. Values outside the bitmap
+/// are never in the set.
+///
+/// A summary level keeps one bit per word that may be non-empty, so that
+/// FindNext skips 64 empty words at a time. The bit of a word is set
+/// whenever the word has bits set, and possibly for a while after it empties.
+///
+class ConcurrentBitmap {
+ public:
+  explicit ConcurrentBitmap(uint64_t size)
+      : size_(size),
+        num_words_((size + 63) / 64),
+        words_(new std::atomic<uint64_t>[num_words_]),
+        num_summary_words_((num_words_ + 63) / 64),
+        summary_(new std::atomic<uint64_t>[num_summary_words_]),
+        count_(0) {
+    for (uint64_t i = 0; i < num_words_; ++i) {
+      words_[i].store(0, std::memory_order_relaxed);
+    }
+    for (uint64_t i = 0; i < num_summary_words_; ++i) {
+      summary_[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  void Set(uint64_t i);
+  void Clear(uint64_t i);
+  bool Test(uint64_t i) const;
+
+  ///
+  /// Finds the first value in the set at or after from, wrapping around.
+  /// @return false if the set is empty.
+  ///
+  bool FindNext(uint64_t from, uint64_t *found) const;
+
+  uint64_t size() const { return size_; }
+  uint64_t Count() const { return count_.load(std::memory_order_relaxed); }
+
+ private:
+  static uint64_t Bit(uint64_t i) { return 1ULL << (i % 64); }
+
+  const uint64_t size_;
+  const uint64_t num_words_;
+  std::unique_ptr<std::atomic<uint64_t>[]> words_;
+  const uint64_t num_summary_words_;
+  std::unique_ptr<std::atomic<uint64_t>[]> summary_;  /// Bit per word in use
+  std::atomic<uint64_t> count_;
+};
+
+// The word and summary updates are sequentially consistent: a Clear that
+// empties a word and then drops its summary bit re-checks the word, and must
+// see any bit set by a Set that found the summary bit still up.
+
+inline void ConcurrentBitmap::Set(uint64_t i) {
+  if (i >= size_) return;
+  const uint64_t w = i / 64;
+  uint64_t old = words_[w].fetch_or(Bit(i));
+  if (old & Bit(i)) return;
+  count_.fetch_add(1, std::memory_order_relaxed);
+  if (!(summary_[w / 64].load() & Bit(w))) summary_[w / 64].fetch_or(Bit(w));
+}
+
+inline void ConcurrentBitmap::Clear(uint64_t i) {
+  if (i >= size_) return;
+  // Most keys written are not in the set; skip the atomic write for them
+  if (!Test(i)) return;
+  const uint64_t w = i / 64;
+  uint64_t old = words_[w].fetch_and(~Bit(i));
+  if (!(old & Bit(i))) return;
+  count_.fetch_sub(1, std::memory_order_relaxed);
+  if (old == Bit(i)) {
+    summary_[w / 64].fetch_and(~Bit(w));
+    // A bit set meanwhile may have seen the summary bit up and left it
+    if (words_[w].load()) summary_[w / 64].fetch_or(Bit(w));
+  }
+}
+
+inline bool ConcurrentBitmap::Test(uint64_t i) const {
+  if (i >= size_) return false;
+  return words_[i / 64].load(std::memory_order_relaxed) & Bit(i);
+}
+
+inline bool ConcurrentBitmap::FindNext(uint64_t from, uint64_t *found) const {
+  if (Count() == 0 || num_words_ == 0) return false;
+  if (from >= size_) from = 0;
+  const uint64_t first = from / 64;
+  uint64_t bits = words_[first].load() & (~0ULL << (from % 64));
+  if (bits) {
+    *found = first * 64 + __builtin_ctzll(bits);
+    return true;
+  }
+  // The words after the first, wrapping around to the first again as a
+  // whole, visiting only those the summary marks
+  uint64_t n = 1;
+  while (n <= num_words_) {
+    uint64_t w = (first + n) % num_words_;
+    uint64_t marked = summary_[w / 64].load() & (~0ULL << (w % 64));
+    if (!marked) {
+      n += std::min(64 - w % 64, num_words_ - w);
+      continue;
+    }
+    uint64_t next = w / 64 * 64 + __builtin_ctzll(marked);
+    n += next - w;
+    if (n > num_words_) break;
+    bits = words_[next].load();
+    if (bits) {
+      *found = next * 64 + __builtin_ctzll(bits);
+      return true;
+    }
+    ++n;  // Emptied since it was marked
+  }
+  return false;
+}
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_CONCURRENT_BITMAP_H_
@@ -8,10 +8,20 @@
 
 #include "core_workload.h"
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <sstream>
 #include <string>
 
 #include "const_generator.h"
+#include "exponential_generator.h"
+#include "histogram_generator.h"
+#include "hotspot_generator.h"
+#include "pareto_generator.h"
 #include "scrambled_zipfian_generator.h"
+#include "sequential_generator.h"
+#include "shifting_generator.h"
 #include "skewed_latest_generator.h"
 #include "uniform_generator.h"
 #include "zipfian_generator.h"
@@ -22,16 +32,48 @@ using ycsbc::CoreWorkload;
 const string CoreWorkload::TABLENAME_PROPERTY = "table";
 const string CoreWorkload::TABLENAME_DEFAULT = "usertable";
 
+const string CoreWorkload::TABLES_PROPERTY = "tables";
+const string CoreWorkload::TABLE_PROPERTY_PREFIX = "table.";
+
+const string CoreWorkload::TABLE_WEIGHT_PROPERTY = "weight";
+const string CoreWorkload::TABLE_WEIGHT_DEFAULT = "1";
+
 const string CoreWorkload::FIELD_COUNT_PROPERTY = "fieldcount";
 const string CoreWorkload::FIELD_COUNT_DEFAULT = "10";
 
+const string CoreWorkload::FIELD_COUNT_DISTRIBUTION_PROPERTY =
+    "fieldcountdistribution";
+const string CoreWorkload::FIELD_COUNT_DISTRIBUTION_DEFAULT = "constant";
+
+const string CoreWorkload::FIELD_COUNT_HISTOGRAM_PROPERTY =
+    "fieldcounthistogram";
+
 const string CoreWorkload::FIELD_LENGTH_DISTRIBUTION_PROPERTY =
     "field_len_dist";
 const string CoreWorkload::FIELD_LENGTH_DISTRIBUTION_DEFAULT = "constant";
 
+const string CoreWorkload::FIELD_LENGTH_HISTOGRAM_PROPERTY =
+    "fieldlengthhistogram";
+
+const string CoreWorkload::PARETO_LOCATION_SUFFIX = ".pareto.location";
+const string CoreWorkload::PARETO_LOCATION_DEFAULT = "0";
+
+const string CoreWorkload::PARETO_SCALE_SUFFIX = ".pareto.scale";
+const string CoreWorkload::PARETO_SCALE_DEFAULT = "25.45";
+
+const string CoreWorkload::PARETO_SHAPE_SUFFIX = ".pareto.shape";
+const string CoreWorkload::PARETO_SHAPE_DEFAULT = "0.2615";
+
 const string CoreWorkload::FIELD_LENGTH_PROPERTY = "fieldlength";
 const string CoreWorkload::FIELD_LENGTH_DEFAULT = "100";
 
+const string CoreWorkload::VALUE_COMPRESSION_RATIO_PROPERTY =
+    "valuecompressionratio";
+const string CoreWorkload::VALUE_COMPRESSION_RATIO_DEFAULT = "0.5";
+
+const string CoreWorkload::VALUE_POOL_SIZE_PROPERTY = "valuepoolsize";
+const string CoreWorkload::VALUE_POOL_SIZE_DEFAULT = "1048576";
+
 const string CoreWorkload::READ_ALL_FIELDS_PROPERTY = "readallfields";
 const string CoreWorkload::READ_ALL_FIELDS_DEFAULT = "true";
 
@@ -54,10 +96,74 @@ const string CoreWorkload::READMODIFYWRITE_PROPORTION_PROPERTY =
     "readmodifywriteproportion";
 const string CoreWorkload::READMODIFYWRITE_PROPORTION_DEFAULT = "0.0";
 
+const string CoreWorkload::DELETE_PROPORTION_PROPERTY = "deleteproportion";
+const string CoreWorkload::DELETE_PROPORTION_DEFAULT = "0.0";
+
+const string CoreWorkload::TRANSACTION_PROPORTION_PROPERTY =
+    "transactionproportion";
+const string CoreWorkload::TRANSACTION_PROPORTION_DEFAULT = "0.0";
+
+const string CoreWorkload::TRANSACTION_KEYS_PROPERTY = "transactionkeys";
+const string CoreWorkload::TRANSACTION_KEYS_DEFAULT = "4";
+
+const string CoreWorkload::TRANSACTION_RETRIES_PROPERTY = "transactionretries";
+const string CoreWorkload::TRANSACTION_RETRIES_DEFAULT = "10";
+
+const string CoreWorkload::BATCH_READ_PROPORTION_PROPERTY =
+    "batchreadproportion";
+const string CoreWorkload::BATCH_READ_PROPORTION_DEFAULT = "0.0";
+
+const string CoreWorkload::BATCH_SIZE_PROPERTY = "batchsize";
+const string CoreWorkload::BATCH_SIZE_DEFAULT = "16";
+
+const string CoreWorkload::READ_DELETED_PROPORTION_PROPERTY =
+    "readdeletedproportion";
+const string CoreWorkload::READ_DELETED_PROPORTION_DEFAULT = "0";
+
+const string CoreWorkload::READ_SKIP_DELETED_PROPERTY = "readskipdeleted";
+const string CoreWorkload::READ_SKIP_DELETED_DEFAULT = "false";
+
 const string CoreWorkload::REQUEST_DISTRIBUTION_PROPERTY =
     "requestdistribution";
 const string CoreWorkload::REQUEST_DISTRIBUTION_DEFAULT = "uniform";
 
+const string CoreWorkload::ZIPFIAN_CONSTANT_PROPERTY = "zipfianconstant";
+const string CoreWorkload::ZIPFIAN_CONSTANT_DEFAULT = "0.99";
+
+const string CoreWorkload::HOTSPOT_DATA_FRACTION_PROPERTY =
+    "hotspotdatafraction";
+const string CoreWorkload::HOTSPOT_DATA_FRACTION_DEFAULT = "0.2";
+
+const string CoreWorkload::HOTSPOT_OPN_FRACTION_PROPERTY = "hotspotopnfraction";
+const string CoreWorkload::HOTSPOT_OPN_FRACTION_DEFAULT = "0.8";
+
+const string CoreWorkload::EXPONENTIAL_PERCENTILE_PROPERTY =
+    "exponential.percentile";
+const string CoreWorkload::EXPONENTIAL_PERCENTILE_DEFAULT = "95";
+
+const string CoreWorkload::EXPONENTIAL_FRAC_PROPERTY = "exponential.frac";
+const string CoreWorkload::EXPONENTIAL_FRAC_DEFAULT = "0.8571428571";
+
+const string CoreWorkload::KEY_SHIFT_FRACTION_PROPERTY = "keyshiftfraction";
+const string CoreWorkload::KEY_SHIFT_FRACTION_DEFAULT = "0";
+
+const string CoreWorkload::KEY_SHIFT_TIME_PROPERTY = "keyshifttime";
+const string CoreWorkload::KEY_SHIFT_TIME_DEFAULT = "10";
+
+const string CoreWorkload::KEY_SHIFT_OPS_PROPERTY = "keyshiftops";
+const string CoreWorkload::KEY_SHIFT_OPS_DEFAULT = "0";
+
+const string CoreWorkload::KEY_SHIFT_MODE_PROPERTY = "keyshiftmode";
+const string CoreWorkload::KEY_SHIFT_MODE_DEFAULT = "rotate";
+
+const string CoreWorkload::END_PROPORTION_PREFIX = "end";
+
+const string CoreWorkload::MIX_RAMP_TIME_PROPERTY = "mixramptime";
+const string CoreWorkload::MIX_RAMP_TIME_DEFAULT = "0";
+
+const string CoreWorkload::MIX_RAMP_OPS_PROPERTY = "mixrampops";
+const string CoreWorkload::MIX_RAMP_OPS_DEFAULT = "0";
+
 const string CoreWorkload::MAX_SCAN_LENGTH_PROPERTY = "maxscanlength";
 const string CoreWorkload::MAX_SCAN_LENGTH_DEFAULT = "1000";
 
@@ -71,15 +177,99 @@ const string CoreWorkload::INSERT_ORDER_DEFAULT = "hashed";
 const string CoreWorkload::INSERT_START_PROPERTY = "insertstart";
 const string CoreWorkload::INSERT_START_DEFAULT = "0";
 
+const string CoreWorkload::KEY_LENGTH_PROPERTY = "keylength";
+const string CoreWorkload::KEY_LENGTH_DEFAULT = "0";
+
+const string CoreWorkload::KEY_FORMAT_PROPERTY = "keyformat";
+const string CoreWorkload::KEY_FORMAT_DEFAULT = "padded";
+
+const string CoreWorkload::VERIFY_PROPERTY = "verify";
+const string CoreWorkload::VERIFY_DEFAULT = "false";
+
 const string CoreWorkload::RECORD_COUNT_PROPERTY = "recordcount";
 const string CoreWorkload::OPERATION_COUNT_PROPERTY = "operationcount";
 
+std::vector<string> CoreWorkload::TableNames(const utils::Properties &p) {
+  std::vector<string> names;
+  std::istringstream list(p.GetProperty(TABLES_PROPERTY));
+  string name;
+  while (std::getline(list, name, ',')) {
+    name = utils::Trim(name);
+    if (name.empty()) continue;
+    if (std::find(names.begin(), names.end(), name) != names.end()) {
+      throw utils::Exception("Table listed twice: " + name);
+    }
+    names.push_back(name);
+  }
+  if (names.empty()) {
+    names.push_back(p.GetProperty(TABLENAME_PROPERTY, TABLENAME_DEFAULT));
+  }
+  return names;
+}
+
+utils::Properties CoreWorkload::TableProperties(const utils::Properties &p,
+                                                const string &table) {
+  const string prefix = TABLE_PROPERTY_PREFIX + table + ".";
+  utils::Properties table_props = p;
+  for (auto &property : p.properties()) {
+    if (property.first.compare(0, prefix.size(), prefix) == 0) {
+      table_props.SetProperty(property.first.substr(prefix.size()),
+                              property.second);
+    }
+  }
+  table_props.SetProperty(TABLENAME_PROPERTY, table);
+  table_props.SetProperty(TABLES_PROPERTY, "");
+  return table_props;
+}
+
 void CoreWorkload::Init(const utils::Properties &p) {
+  verify_ = utils::StrToBool(p.GetProperty(VERIFY_PROPERTY, VERIFY_DEFAULT));
+  if (!p.GetProperty(TABLES_PROPERTY).empty()) {
+    // The tables do all the work
+    std::vector<string> names = TableNames(p);
+    if (names.size() > 256) {
+      throw utils::Exception("At most 256 tables are supported");
+    }
+    double total_weight = 0;
+    for (size_t i = 0; i < names.size(); ++i) {
+      utils::Properties table_props = TableProperties(p, names[i]);
+      tables_.push_back(new CoreWorkload);
+      tables_.back()->SetVersionTables(version_tables_);
+      tables_.back()->Init(table_props);
+      double weight = std::stod(
+          table_props.GetProperty(TABLE_WEIGHT_PROPERTY, TABLE_WEIGHT_DEFAULT));
+      if (weight > 0) {
+        table_chooser_.AddValue(i, weight);
+        total_weight += weight;
+      }
+      load_count_ += tables_.back()->load_count();
+      load_ends_.push_back(load_count_);
+    }
+    if (total_weight <= 0) {
+      throw utils::Exception("No table has a positive weight");
+    }
+    return;
+  }
+
   table_name_ = p.GetProperty(TABLENAME_PROPERTY, TABLENAME_DEFAULT);
 
   field_count_ =
       std::stoi(p.GetProperty(FIELD_COUNT_PROPERTY, FIELD_COUNT_DEFAULT));
   field_len_generator_ = GetFieldLenGenerator(p);
+  field_count_generator_ = GetFieldCountGenerator(p);
+  for (int i = 0; i < field_count_; ++i) {
+    field_names_.push_back(FieldName(i));
+  }
+
+  // Fields up to fieldlength fit in the pool; longer ones from a histogram
+  // are pieced together
+  size_t pool_size = std::max<size_t>(
+      std::stoul(
+          p.GetProperty(VALUE_POOL_SIZE_PROPERTY, VALUE_POOL_SIZE_DEFAULT)),
+      std::stoul(p.GetProperty(FIELD_LENGTH_PROPERTY, FIELD_LENGTH_DEFAULT)));
+  value_pool_ = new ValuePool(
+      pool_size, std::stod(p.GetProperty(VALUE_COMPRESSION_RATIO_PROPERTY,
+                                         VALUE_COMPRESSION_RATIO_DEFAULT)));
 
   double read_proportion = std::stod(
       p.GetProperty(READ_PROPORTION_PROPERTY, READ_PROPORTION_DEFAULT));
@@ -91,8 +281,27 @@ void CoreWorkload::Init(const utils::Properties &p) {
       p.GetProperty(SCAN_PROPORTION_PROPERTY, SCAN_PROPORTION_DEFAULT));
   double readmodifywrite_proportion = std::stod(p.GetProperty(
       READMODIFYWRITE_PROPORTION_PROPERTY, READMODIFYWRITE_PROPORTION_DEFAULT));
+  double delete_proportion = std::stod(
+      p.GetProperty(DELETE_PROPORTION_PROPERTY, DELETE_PROPORTION_DEFAULT));
+  double transaction_proportion = std::stod(p.GetProperty(
+      TRANSACTION_PROPORTION_PROPERTY, TRANSACTION_PROPORTION_DEFAULT));
+  transaction_keys_ = std::stoul(
+      p.GetProperty(TRANSACTION_KEYS_PROPERTY, TRANSACTION_KEYS_DEFAULT));
+  transaction_retries_ = std::stoi(
+      p.GetProperty(TRANSACTION_RETRIES_PROPERTY, TRANSACTION_RETRIES_DEFAULT));
+  if (transaction_keys_ == 0) {
+    throw utils::Exception("Transactions need at least one key");
+  }
+  double batch_read_proportion = std::stod(p.GetProperty(
+      BATCH_READ_PROPORTION_PROPERTY, BATCH_READ_PROPORTION_DEFAULT));
+  batch_size_ =
+      std::stoul(p.GetProperty(BATCH_SIZE_PROPERTY, BATCH_SIZE_DEFAULT));
+  if (batch_size_ == 0) {
+    throw utils::Exception("Batched reads need at least one key");
+  }
 
   record_count_ = std::stoi(p.GetProperty(RECORD_COUNT_PROPERTY));
+  load_count_ = record_count_;
   std::string request_dist = p.GetProperty(REQUEST_DISTRIBUTION_PROPERTY,
                                            REQUEST_DISTRIBUTION_DEFAULT);
   int max_scan_len = std::stoi(
@@ -113,6 +322,25 @@ void CoreWorkload::Init(const utils::Properties &p) {
     ordered_inserts_ = true;
   }
 
+  key_length_ =
+      std::stoul(p.GetProperty(KEY_LENGTH_PROPERTY, KEY_LENGTH_DEFAULT));
+  std::string key_format =
+      p.GetProperty(KEY_FORMAT_PROPERTY, KEY_FORMAT_DEFAULT);
+  if (key_format == "binary") {
+    binary_keys_ = true;
+  } else if (key_format != "padded") {
+    throw utils::Exception("Unknown key format: " + key_format);
+  } else if (key_length_ && key_length_ <= 4) {
+    throw utils::Exception("Padded keys must be longer than 4 bytes");
+  }
+  // Hashed key numbers use all 64 bits, and a fixed-width key keeps only
+  // their low digits, so distinct records would share a key
+  if (key_length_ && !ordered_inserts_ && key_length_ < MinHashedKeyLength()) {
+    throw utils::Exception("Hashed " + key_format + " keys need keylength " +
+                           std::to_string(MinHashedKeyLength()) +
+                           " or more (or insertorder=ordered)");
+  }
+
   key_generator_ = new CounterGenerator(insert_start);
 
   if (read_proportion > 0) {
@@ -130,9 +358,98 @@ void CoreWorkload::Init(const utils::Properties &p) {
   if (readmodifywrite_proportion > 0) {
     op_chooser_.AddValue(READMODIFYWRITE, readmodifywrite_proportion);
   }
+  if (delete_proportion > 0) {
+    op_chooser_.AddValue(DELETE, delete_proportion);
+  }
+  if (transaction_proportion > 0) {
+    op_chooser_.AddValue(TRANSACTION, transaction_proportion);
+  }
+  if (batch_read_proportion > 0) {
+    op_chooser_.AddValue(BATCHREAD, batch_read_proportion);
+  }
+
+  // A second mix to ramp to; proportions not given stay as they are
+  const struct {
+    Operation op;
+    const std::string &property;
+    double proportion;
+  } mix[] = {
+      {READ, READ_PROPORTION_PROPERTY, read_proportion},
+      {UPDATE, UPDATE_PROPORTION_PROPERTY, update_proportion},
+      {INSERT, INSERT_PROPORTION_PROPERTY, insert_proportion},
+      {SCAN, SCAN_PROPORTION_PROPERTY, scan_proportion},
+      {READMODIFYWRITE, READMODIFYWRITE_PROPORTION_PROPERTY,
+       readmodifywrite_proportion},
+      {DELETE, DELETE_PROPORTION_PROPERTY, delete_proportion},
+      {TRANSACTION, TRANSACTION_PROPORTION_PROPERTY, transaction_proportion},
+      {BATCHREAD, BATCH_READ_PROPORTION_PROPERTY, batch_read_proportion},
+  };
+  double max_insert_proportion = insert_proportion;
+  double max_delete_proportion = delete_proportion;
+  for (auto &m : mix) {
+    const std::string property = END_PROPORTION_PREFIX + m.property;
+    if (p.properties().count(property)) ramp_mix_ = true;
+    double proportion =
+        std::stod(p.GetProperty(property, std::to_string(m.proportion)));
+    if (proportion > 0) end_op_chooser_.AddValue(m.op, proportion);
+    if (m.op == INSERT) {
+      max_insert_proportion = std::max(max_insert_proportion, proportion);
+    } else if (m.op == DELETE) {
+      max_delete_proportion = std::max(max_delete_proportion, proportion);
+    }
+  }
+  if (ramp_mix_) {
+    double ramp_time = std::stod(
+        p.GetProperty(MIX_RAMP_TIME_PROPERTY, MIX_RAMP_TIME_DEFAULT));
+    uint64_t ramp_ops = std::stoull(
+        p.GetProperty(MIX_RAMP_OPS_PROPERTY, MIX_RAMP_OPS_DEFAULT));
+    if (ramp_ops == 0 && ramp_time <= 0) {
+      ramp_ops = std::stoull(p.GetProperty(OPERATION_COUNT_PROPERTY));
+    }
+    ramp_by_ops_ = ramp_ops > 0;
+    ramp_length_ = ramp_by_ops_ ? ramp_ops : ramp_time;
+    if (ramp_length_ <= 0) {
+      throw utils::Exception("The operation mix ramp needs a length");
+    }
+    count_ops_ |= ramp_by_ops_;
+  }
 
   insert_key_sequence_.Set(record_count_);
 
+  // Keys deleted are tracked up to this
+  uint64_t tracked_keys =
+      record_count_ +
+      std::stoull(p.GetProperty(OPERATION_COUNT_PROPERTY, "0")) *
+          max_insert_proportion;
+  if (key_length_ && ordered_inserts_ &&
+      !KeyFits(insert_start + tracked_keys - 1)) {
+    throw utils::Exception("keylength " + std::to_string(key_length_) +
+                           " is too short for " +
+                           std::to_string(insert_start + tracked_keys) +
+                           " keys");
+  }
+  if (verify_) {
+    if (!version_tables_) {
+      version_tables_ = own_version_tables_ = new VersionTables;
+    }
+    versions_ = version_tables_->Get(table_name_);
+  }
+
+  if (max_delete_proportion > 0) {
+    deleted_keys_ = new ConcurrentBitmap(tracked_keys);
+    read_deleted_proportion_ = std::stod(p.GetProperty(
+        READ_DELETED_PROPORTION_PROPERTY, READ_DELETED_PROPORTION_DEFAULT));
+    read_skip_deleted_ = utils::StrToBool(
+        p.GetProperty(READ_SKIP_DELETED_PROPERTY, READ_SKIP_DELETED_DEFAULT));
+  }
+
+  double zipfian_const = std::stod(
+      p.GetProperty(ZIPFIAN_CONSTANT_PROPERTY, ZIPFIAN_CONSTANT_DEFAULT));
+  if (zipfian_const <= 0 || zipfian_const >= 1) {
+    throw utils::Exception("Zipfian constant must be between 0 and 1");
+  }
+
+  uint64_t key_range = record_count_;  // Key chooser values are below it
   if (request_dist == "uniform") {
     key_chooser_ = new UniformGenerator(0, record_count_ - 1);
 
@@ -143,16 +460,66 @@ void CoreWorkload::Init(const utils::Properties &p) {
     // If the generator picks a key that is not inserted yet, we just ignore it
     // and pick another key.
     int op_count = std::stoi(p.GetProperty(OPERATION_COUNT_PROPERTY));
-    int new_keys = (int)(op_count * insert_proportion * 2);  // a fudge factor
-    key_chooser_ = new ScrambledZipfianGenerator(record_count_ + new_keys);
+    int new_keys =
+        (int)(op_count * max_insert_proportion * 2);  // a fudge factor
+    key_range = record_count_ + new_keys;
+    key_chooser_ =
+        new ScrambledZipfianGenerator(0, key_range - 1, zipfian_const);
 
   } else if (request_dist == "latest") {
-    key_chooser_ = new SkewedLatestGenerator(insert_key_sequence_);
+    key_chooser_ =
+        new SkewedLatestGenerator(insert_key_sequence_, zipfian_const);
+
+  } else if (request_dist == "hotspot") {
+    double hot_set_fraction = std::stod(p.GetProperty(
+        HOTSPOT_DATA_FRACTION_PROPERTY, HOTSPOT_DATA_FRACTION_DEFAULT));
+    double hot_op_fraction = std::stod(p.GetProperty(
+        HOTSPOT_OPN_FRACTION_PROPERTY, HOTSPOT_OPN_FRACTION_DEFAULT));
+    key_chooser_ = new HotspotGenerator(0, record_count_ - 1, hot_set_fraction,
+                                        hot_op_fraction);
+
+  } else if (request_dist == "exponential") {
+    double percentile = std::stod(p.GetProperty(
+        EXPONENTIAL_PERCENTILE_PROPERTY, EXPONENTIAL_PERCENTILE_DEFAULT));
+    double frac = std::stod(
+        p.GetProperty(EXPONENTIAL_FRAC_PROPERTY, EXPONENTIAL_FRAC_DEFAULT));
+    key_chooser_ = new ExponentialGenerator(percentile, record_count_ * frac);
+    keys_from_latest_ = true;
+
+  } else if (request_dist == "sequential") {
+    key_chooser_ = new SequentialGenerator(0, record_count_ - 1);
 
   } else {
     throw utils::Exception("Unknown request distribution: " + request_dist);
   }
 
+  double shift_fraction = std::stod(
+      p.GetProperty(KEY_SHIFT_FRACTION_PROPERTY, KEY_SHIFT_FRACTION_DEFAULT));
+  if (shift_fraction > 0) {
+    if (request_dist == "latest" || request_dist == "exponential") {
+      throw utils::Exception("Keys cannot shift with request distribution " +
+                             request_dist);
+    }
+    double shift_time = std::stod(
+        p.GetProperty(KEY_SHIFT_TIME_PROPERTY, KEY_SHIFT_TIME_DEFAULT));
+    uint64_t shift_ops = std::stoull(
+        p.GetProperty(KEY_SHIFT_OPS_PROPERTY, KEY_SHIFT_OPS_DEFAULT));
+    std::string shift_mode =
+        p.GetProperty(KEY_SHIFT_MODE_PROPERTY, KEY_SHIFT_MODE_DEFAULT);
+    if (shift_mode != "rotate" && shift_mode != "drift") {
+      throw utils::Exception("Unknown key shift mode: " + shift_mode);
+    }
+    if (shift_ops == 0 && shift_time <= 0) {
+      throw utils::Exception("Key shifts need an interval");
+    }
+    key_chooser_ = new ShiftingGenerator(
+        key_chooser_, key_range,
+        std::max<uint64_t>(1, key_range * std::min(shift_fraction, 1.0)),
+        shift_ops ? shift_ops : shift_time, shift_mode == "drift", clock_,
+        shift_ops > 0);
+    count_ops_ |= shift_ops > 0;
+  }
+
   field_chooser_ = new UniformGenerator(0, field_count_ - 1);
 
   if (scan_len_dist == "uniform") {
@@ -165,6 +532,27 @@ void CoreWorkload::Init(const utils::Properties &p) {
   }
 }
 
+void CoreWorkload::SaveRecordCounts(utils::Properties *p) {
+  // Keys up to Last() are all inserted
+  if (tables_.empty()) {
+    p->SetProperty(RECORD_COUNT_PROPERTY,
+                   std::to_string(insert_key_sequence_.Last() + 1));
+  }
+  for (CoreWorkload *table : tables_) {
+    p->SetProperty(
+        TABLE_PROPERTY_PREFIX + table->table_name_ + "." +
+            RECORD_COUNT_PROPERTY,
+        std::to_string(table->insert_key_sequence_.Last() + 1));
+  }
+}
+
+void CoreWorkload::StartClock() {
+  clock_.Start();
+  for (CoreWorkload *table : tables_) {
+    table->StartClock();
+  }
+}
+
 ycsbc::Generator<uint64_t> *CoreWorkload::GetFieldLenGenerator(
     const utils::Properties &p) {
   string field_len_dist = p.GetProperty(FIELD_LENGTH_DISTRIBUTION_PROPERTY,
@@ -177,24 +565,149 @@ ycsbc::Generator<uint64_t> *CoreWorkload::GetFieldLenGenerator(
     return new UniformGenerator(1, field_len);
   } else if (field_len_dist == "zipfian") {
     return new ZipfianGenerator(1, field_len);
+  } else if (field_len_dist == "histogram") {
+    return new HistogramGenerator(
+        p.GetProperty(FIELD_LENGTH_HISTOGRAM_PROPERTY));
+  } else if (field_len_dist == "pareto") {
+    return GetParetoGenerator(p, FIELD_LENGTH_PROPERTY, field_len);
   } else {
     throw utils::Exception("Unknown field length distribution: " +
                            field_len_dist);
   }
 }
 
-void CoreWorkload::BuildValues(std::vector<ycsbc::DB::KVPair> &values) {
-  for (int i = 0; i < field_count_; ++i) {
-    ycsbc::DB::KVPair pair;
-    pair.first.append("field").append(std::to_string(i));
-    pair.second.append(field_len_generator_->Next(), utils::RandomPrintChar());
-    values.push_back(pair);
+ycsbc::Generator<uint64_t> *CoreWorkload::GetFieldCountGenerator(
+    const utils::Properties &p) {
+  string field_count_dist = p.GetProperty(FIELD_COUNT_DISTRIBUTION_PROPERTY,
+                                          FIELD_COUNT_DISTRIBUTION_DEFAULT);
+  int field_count =
+      std::stoi(p.GetProperty(FIELD_COUNT_PROPERTY, FIELD_COUNT_DEFAULT));
+  if (field_count_dist == "constant") {
+    return new ConstGenerator(field_count);
+  } else if (field_count_dist == "uniform") {
+    return new UniformGenerator(1, field_count);
+  } else if (field_count_dist == "histogram") {
+    return new HistogramGenerator(
+        p.GetProperty(FIELD_COUNT_HISTOGRAM_PROPERTY));
+  } else if (field_count_dist == "pareto") {
+    // The default parameters model value sizes in bytes; as numbers of
+    // fields, most records would be clamped to fieldcount
+    for (const string &suffix : {PARETO_SCALE_SUFFIX, PARETO_SHAPE_SUFFIX}) {
+      if (!p.properties().count(FIELD_COUNT_PROPERTY + suffix)) {
+        throw utils::Exception("A Pareto field count needs " +
+                               FIELD_COUNT_PROPERTY + suffix);
+      }
+    }
+    return GetParetoGenerator(p, FIELD_COUNT_PROPERTY, field_count);
+  } else {
+    throw utils::Exception("Unknown field count distribution: " +
+                           field_count_dist);
   }
 }
 
-void CoreWorkload::BuildUpdate(std::vector<ycsbc::DB::KVPair> &update) {
-  ycsbc::DB::KVPair pair;
-  pair.first.append(NextFieldName());
-  pair.second.append(field_len_generator_->Next(), utils::RandomPrintChar());
-  update.push_back(pair);
+ycsbc::Generator<uint64_t> *CoreWorkload::GetParetoGenerator(
+    const utils::Properties &p, const string &prefix, uint64_t max) {
+  double location = std::stod(
+      p.GetProperty(prefix + PARETO_LOCATION_SUFFIX, PARETO_LOCATION_DEFAULT));
+  double scale = std::stod(
+      p.GetProperty(prefix + PARETO_SCALE_SUFFIX, PARETO_SCALE_DEFAULT));
+  double shape = std::stod(
+      p.GetProperty(prefix + PARETO_SHAPE_SUFFIX, PARETO_SHAPE_DEFAULT));
+  if (scale <= 0) {
+    throw utils::Exception("Pareto scale must be positive");
+  }
+  return new ParetoGenerator(location, scale, shape, 1, max);
+}
+
+void CoreWorkload::BuildValues(ValueBuffer &values) {
+  size_t field_count = NextFieldCount();
+  values.Clear();
+  for (size_t i = 0; i < field_count; ++i) {
+    values.Add(field_names_[i],
+               BuildValue(field_len_generator_->Next(), values));
+  }
+}
+
+void CoreWorkload::BuildUpdate(ValueBuffer &update) {
+  update.Clear();
+  const std::string &name = field_names_[field_chooser_->Next()];
+  update.Add(name, BuildValue(field_len_generator_->Next(), update));
+}
+
+void CoreWorkload::BuildValues(ValueBuffer &values, size_t field_count,
+                               size_t field_len) {
+  if (field_count == 0) field_count = field_count_;
+  field_count = std::min<size_t>(field_count, field_count_);
+  values.Clear();
+  for (size_t i = 0; i < field_count; ++i) {
+    values.Add(field_names_[i], BuildValue(field_len, values));
+  }
+}
+
+void CoreWorkload::BuildUpdate(ValueBuffer &update, uint64_t field,
+                               size_t field_len) {
+  update.Clear();
+  update.Add(field_names_[field], BuildValue(field_len, update));
+}
+
+void CoreWorkload::CheckOpRecord(const OpRecord &record) const {
+  // COMMIT only measures transactions
+  if (record.op >= COMMIT) {
+    throw utils::Exception("Unknown operation " + std::to_string(record.op) +
+                           " in operation stream");
+  }
+  if (record.table >= table_count()) {
+    throw utils::Exception("Operation stream uses table " +
+                           std::to_string(record.table) + " of only " +
+                           std::to_string(table_count()));
+  }
+  const CoreWorkload &table = tables_.empty() ? *this : *tables_[record.table];
+  if (record.field >= table.field_count_) {
+    throw utils::Exception("Operation stream uses field " +
+                           std::to_string(record.field) + " of only " +
+                           std::to_string(table.field_count_));
+  }
+}
+
+void CoreWorkload::CheckForOpStream() const {
+  for (size_t i = 0; i < table_count(); ++i) {
+    const CoreWorkload &table = tables_.empty() ? *this : *tables_[i];
+    if (table.field_count_ > std::numeric_limits<uint16_t>::max()) {
+      throw utils::Exception(
+          "Operation streams hold at most 65535 fields per record, not " +
+          std::to_string(table.field_count_));
+    }
+  }
+}
+
+ycsbc::OpRecord CoreWorkload::NextOpRecord() {
+  if (!tables_.empty()) {
+    size_t table = table_chooser_.Next();
+    OpRecord record = tables_[table]->NextOpRecord();
+    record.table = table;
+    return record;
+  }
+  OpRecord record;
+  memset(&record, 0, sizeof(record));
+  Operation op = NextOperation();
+  record.op = op;
+  if (op == INSERT) {
+    record.key = insert_key_sequence_.Next();
+    AcknowledgeInsert(record.key);
+  } else if (op == READ || op == SCAN || op == BATCHREAD) {
+    record.key = NextReadKeyNum();
+  } else {
+    record.key = NextTransactionKeyNum();
+  }
+  // The stream is replayed in about the order it is drawn in
+  if (op == DELETE) {
+    RecordDelete(record.key);
+  } else if (op == UPDATE || op == READMODIFYWRITE) {
+    RecordWrite(record.key);
+  }
+  record.field = field_chooser_->Next();
+  if (op == SCAN) record.scan_length = NextScanLength();
+  record.value_length = field_len_generator_->Next();
+  record.field_count = NextFieldCount();
+  return record;
 }
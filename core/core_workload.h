@@ -9,19 +9,70 @@
 #ifndef YCSB_C_CORE_WORKLOAD_H_
 #define YCSB_C_CORE_WORKLOAD_H_
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <string>
 #include <vector>
 
+#include "acknowledged_counter_generator.h"
+#include "concurrent_bitmap.h"
 #include "counter_generator.h"
 #include "db.h"
 #include "discrete_generator.h"
 #include "generator.h"
+#include "op_stream.h"
 #include "properties.h"
 #include "utils.h"
+#include "value_checksum.h"
+#include "value_pool.h"
+#include "version_table.h"
+#include "workload_clock.h"
 
 namespace ycsbc {
 
-enum Operation { INSERT, READ, UPDATE, SCAN, READMODIFYWRITE };
+///
+/// COMMIT is not an operation of its own: it measures the commits of
+/// transactions.
+///
+enum Operation {
+  INSERT,
+  READ,
+  UPDATE,
+  SCAN,
+  READMODIFYWRITE,
+  DELETE,
+  TRANSACTION,
+  BATCHREAD,
+  COMMIT
+};
+
+const int kNumOperations = COMMIT + 1;
+
+inline const char *OperationName(Operation op) {
+  switch (op) {
+    case INSERT:
+      return "INSERT";
+    case READ:
+      return "READ";
+    case UPDATE:
+      return "UPDATE";
+    case SCAN:
+      return "SCAN";
+    case READMODIFYWRITE:
+      return "READMODIFYWRITE";
+    case DELETE:
+      return "DELETE";
+    case TRANSACTION:
+      return "TRANSACTION";
+    case BATCHREAD:
+      return "BATCHREAD";
+    case COMMIT:
+      return "COMMIT";
+    default:
+      return "UNKNOWN";
+  }
+}
 
 class CoreWorkload {
  public:
@@ -31,25 +82,86 @@ class CoreWorkload {
   static const std::string TABLENAME_PROPERTY;
   static const std::string TABLENAME_DEFAULT;
 
+  ///
+  /// The name of the property for a comma-separated list of tables to run
+  /// against instead of the single table above. Any property can be set for
+  /// one table alone by prefixing it with "table.<name>.", e.g.
+  /// "table.hot.recordcount". Operations go to the tables in proportion to
+  /// their "weight" property.
+  ///
+  static const std::string TABLES_PROPERTY;
+  static const std::string TABLE_PROPERTY_PREFIX;
+  static const std::string TABLE_WEIGHT_PROPERTY;
+  static const std::string TABLE_WEIGHT_DEFAULT;
+
   ///
   /// The name of the property for the number of fields in a record.
   ///
   static const std::string FIELD_COUNT_PROPERTY;
   static const std::string FIELD_COUNT_DEFAULT;
 
+  ///
+  /// The name of the property for the distribution of the number of fields
+  /// in a record, of at most fieldcount. Options are "constant" (always
+  /// fieldcount), "uniform", "histogram" and "pareto".
+  ///
+  static const std::string FIELD_COUNT_DISTRIBUTION_PROPERTY;
+  static const std::string FIELD_COUNT_DISTRIBUTION_DEFAULT;
+
+  ///
+  /// The name of the property for the histogram file of the number of fields,
+  /// in the format of HistogramGenerator.
+  ///
+  static const std::string FIELD_COUNT_HISTOGRAM_PROPERTY;
+
   ///
   /// The name of the property for the field length distribution.
-  /// Options are "uniform", "zipfian" (favoring short records), and "constant".
+  /// Options are "uniform", "zipfian" (favoring short records), "constant",
+  /// "histogram" and "pareto". All but histogram stay within fieldlength.
   ///
   static const std::string FIELD_LENGTH_DISTRIBUTION_PROPERTY;
   static const std::string FIELD_LENGTH_DISTRIBUTION_DEFAULT;
 
+  ///
+  /// The name of the property for the histogram file of field lengths, in
+  /// the format of HistogramGenerator.
+  ///
+  static const std::string FIELD_LENGTH_HISTOGRAM_PROPERTY;
+
+  ///
+  /// The suffixes of the properties for the location, scale and shape of the
+  /// generalized Pareto distributions, after "fieldcount" or "fieldlength",
+  /// e.g. "fieldlength.pareto.shape". The defaults are those fitted to value
+  /// sizes in published RocksDB production characterizations, so they apply
+  /// to fieldlength only: a Pareto fieldcount needs its scale and shape.
+  ///
+  static const std::string PARETO_LOCATION_SUFFIX;
+  static const std::string PARETO_LOCATION_DEFAULT;
+  static const std::string PARETO_SCALE_SUFFIX;
+  static const std::string PARETO_SCALE_DEFAULT;
+  static const std::string PARETO_SHAPE_SUFFIX;
+  static const std::string PARETO_SHAPE_DEFAULT;
+
   ///
   /// The name of the property for the length of a field in bytes.
   ///
   static const std::string FIELD_LENGTH_PROPERTY;
   static const std::string FIELD_LENGTH_DEFAULT;
 
+  ///
+  /// The name of the property for the fraction of its size a value
+  /// compresses to, from 0 to 1 (incompressible).
+  ///
+  static const std::string VALUE_COMPRESSION_RATIO_PROPERTY;
+  static const std::string VALUE_COMPRESSION_RATIO_DEFAULT;
+
+  ///
+  /// The name of the property for the size in bytes of the pre-generated
+  /// data that values are sliced from.
+  ///
+  static const std::string VALUE_POOL_SIZE_PROPERTY;
+  static const std::string VALUE_POOL_SIZE_DEFAULT;
+
   ///
   /// The name of the property for deciding whether to read one field (false)
   /// or all fields (true) of a record.
@@ -95,13 +207,138 @@ class CoreWorkload {
   static const std::string READMODIFYWRITE_PROPORTION_PROPERTY;
   static const std::string READMODIFYWRITE_PROPORTION_DEFAULT;
 
+  ///
+  /// The name of the property for the proportion of delete transactions.
+  /// The keys deleted during a run are tracked, unless they were inserted
+  /// beyond what operationcount and the insert proportion allow for.
+  ///
+  static const std::string DELETE_PROPORTION_PROPERTY;
+  static const std::string DELETE_PROPORTION_DEFAULT;
+
+  ///
+  /// The name of the property for the proportion of transactions that read
+  /// and write several records atomically.
+  ///
+  static const std::string TRANSACTION_PROPORTION_PROPERTY;
+  static const std::string TRANSACTION_PROPORTION_DEFAULT;
+
+  ///
+  /// The name of the property for the number of keys a transaction draws
+  /// from the request distribution. Keys drawn twice are accessed once.
+  ///
+  static const std::string TRANSACTION_KEYS_PROPERTY;
+  static const std::string TRANSACTION_KEYS_DEFAULT;
+
+  ///
+  /// The name of the property for how many times a transaction aborted by a
+  /// conflict is retried before giving up.
+  ///
+  static const std::string TRANSACTION_RETRIES_PROPERTY;
+  static const std::string TRANSACTION_RETRIES_DEFAULT;
+
+  ///
+  /// The name of the property for the proportion of batched reads, which
+  /// read several records in one call.
+  ///
+  static const std::string BATCH_READ_PROPORTION_PROPERTY;
+  static const std::string BATCH_READ_PROPORTION_DEFAULT;
+
+  ///
+  /// The name of the property for the number of keys of a batched read.
+  ///
+  static const std::string BATCH_SIZE_PROPERTY;
+  static const std::string BATCH_SIZE_DEFAULT;
+
+  ///
+  /// The name of the property for the proportion of reads and scans that go
+  /// to a key deleted earlier in the run, if there is one.
+  ///
+  static const std::string READ_DELETED_PROPORTION_PROPERTY;
+  static const std::string READ_DELETED_PROPORTION_DEFAULT;
+
+  ///
+  /// The name of the property for whether the other reads and scans skip
+  /// keys deleted earlier in the run.
+  ///
+  static const std::string READ_SKIP_DELETED_PROPERTY;
+  static const std::string READ_SKIP_DELETED_DEFAULT;
+
   ///
   /// The name of the property for the the distribution of request keys.
-  /// Options are "uniform", "zipfian" and "latest".
+  /// Options are "uniform", "zipfian", "latest", "hotspot", "exponential"
+  /// and "sequential".
   ///
   static const std::string REQUEST_DISTRIBUTION_PROPERTY;
   static const std::string REQUEST_DISTRIBUTION_DEFAULT;
 
+  ///
+  /// The name of the property for the skew (theta) of the zipfian and latest
+  /// distributions, between 0 and 1.
+  ///
+  static const std::string ZIPFIAN_CONSTANT_PROPERTY;
+  static const std::string ZIPFIAN_CONSTANT_DEFAULT;
+
+  ///
+  /// The names of the properties for the fraction of the records in the hot
+  /// set and the fraction of the operations on it, for the hotspot
+  /// distribution.
+  ///
+  static const std::string HOTSPOT_DATA_FRACTION_PROPERTY;
+  static const std::string HOTSPOT_DATA_FRACTION_DEFAULT;
+  static const std::string HOTSPOT_OPN_FRACTION_PROPERTY;
+  static const std::string HOTSPOT_OPN_FRACTION_DEFAULT;
+
+  ///
+  /// The names of the properties for the exponential distribution, which
+  /// favors recent keys: the percentile of the operations that fall within
+  /// the given fraction of the records, counted back from the latest.
+  ///
+  static const std::string EXPONENTIAL_PERCENTILE_PROPERTY;
+  static const std::string EXPONENTIAL_PERCENTILE_DEFAULT;
+  static const std::string EXPONENTIAL_FRAC_PROPERTY;
+  static const std::string EXPONENTIAL_FRAC_DEFAULT;
+
+  ///
+  /// The name of the property for the fraction of the key space the request
+  /// keys move by every interval, so that the hot keys change over time.
+  /// 0 (the default) keeps them in place.
+  ///
+  static const std::string KEY_SHIFT_FRACTION_PROPERTY;
+  static const std::string KEY_SHIFT_FRACTION_DEFAULT;
+
+  ///
+  /// The names of the properties for the interval of key shifts, in seconds
+  /// or, if not 0, in operations.
+  ///
+  static const std::string KEY_SHIFT_TIME_PROPERTY;
+  static const std::string KEY_SHIFT_TIME_DEFAULT;
+  static const std::string KEY_SHIFT_OPS_PROPERTY;
+  static const std::string KEY_SHIFT_OPS_DEFAULT;
+
+  ///
+  /// The name of the property for how keys shift: "rotate" (in a step at
+  /// the end of each interval) or "drift" (continuously).
+  ///
+  static const std::string KEY_SHIFT_MODE_PROPERTY;
+  static const std::string KEY_SHIFT_MODE_DEFAULT;
+
+  ///
+  /// The prefix of the proportion properties of a second operation mix, e.g.
+  /// "endreadproportion". If any is given, the mix ramps linearly from the
+  /// first one to the second, which defaults to the proportions of the first.
+  ///
+  static const std::string END_PROPORTION_PREFIX;
+
+  ///
+  /// The names of the properties for the length of the ramp between the two
+  /// operation mixes, in seconds or, if not 0, in operations. With neither
+  /// set, the ramp lasts operationcount operations.
+  ///
+  static const std::string MIX_RAMP_TIME_PROPERTY;
+  static const std::string MIX_RAMP_TIME_DEFAULT;
+  static const std::string MIX_RAMP_OPS_PROPERTY;
+  static const std::string MIX_RAMP_OPS_DEFAULT;
+
   ///
   /// The name of the property for the max scan length (number of records).
   ///
@@ -125,90 +362,538 @@ class CoreWorkload {
   static const std::string INSERT_START_PROPERTY;
   static const std::string INSERT_START_DEFAULT;
 
+  ///
+  /// The name of the property for the length of keys in bytes.
+  /// 0 (the default) keeps variable-length keys "user<number>".
+  ///
+  static const std::string KEY_LENGTH_PROPERTY;
+  static const std::string KEY_LENGTH_DEFAULT;
+
+  ///
+  /// The name of the property for the encoding of fixed-length keys.
+  /// Options are "padded" ("user" and the zero-padded decimal number) and
+  /// "binary" (the number in big-endian, zero-padded on the left). The key
+  /// must hold the largest key number: hashed keys need a keylength of 24
+  /// (padded) or 8 (binary), ordered ones enough digits for the records.
+  ///
+  static const std::string KEY_FORMAT_PROPERTY;
+  static const std::string KEY_FORMAT_DEFAULT;
+
+  ///
+  /// The name of the property for verify mode, in which every value written
+  /// carries a checksum, a key-derived seed and the version of its record
+  /// (see value_checksum.h), and every value read is checked.
+  ///
+  static const std::string VERIFY_PROPERTY;
+  static const std::string VERIFY_DEFAULT;
+
   static const std::string RECORD_COUNT_PROPERTY;
   static const std::string OPERATION_COUNT_PROPERTY;
 
+  ///
+  /// Returns the tables listed by TABLES_PROPERTY, or else the single table.
+  ///
+  static std::vector<std::string> TableNames(const utils::Properties &p);
+  ///
+  /// Returns the properties of one of the tables: those of p, overridden by
+  /// the ones prefixed for the table.
+  ///
+  static utils::Properties TableProperties(const utils::Properties &p,
+                                           const std::string &table);
+
   ///
   /// Initialize the scenario.
   /// Called once, in the main client thread, before any operations are started.
   ///
   virtual void Init(const utils::Properties &p);
+  ///
+  /// In verify mode, makes Init() track versions in the given tables, which
+  /// must outlive this workload, instead of tables of its own. Phases that
+  /// share a DB share them.
+  ///
+  void SetVersionTables(VersionTables *tables) { version_tables_ = tables; }
+
+  ///
+  /// Build the fields of a record or an update, replacing the contents of
+  /// values. The fields are slices of the field names and the value pool of
+  /// this workload, which must outlive them, so passing the same buffer
+  /// every time avoids allocating and copying.
+  ///
+  virtual void BuildValues(ValueBuffer &values);
+  virtual void BuildUpdate(ValueBuffer &update);
+  ///
+  /// Same as above for a pre-generated operation, whose field count, field
+  /// lengths and updated field are given instead of drawn.
+  ///
+  virtual void BuildValues(ValueBuffer &values, size_t field_count,
+                           size_t field_len);
+  virtual void BuildUpdate(ValueBuffer &update, uint64_t field,
+                           size_t field_len);
 
-  virtual void BuildValues(std::vector<ycsbc::DB::KVPair> &values);
-  virtual void BuildUpdate(std::vector<ycsbc::DB::KVPair> &update);
+  ///
+  /// With several tables, each has a workload of its own, initialized with
+  /// the properties of the table, that draws the operations on it. Returns
+  /// the workload of the table of the next operation, chosen by weight, or
+  /// this one if there are no others.
+  ///
+  CoreWorkload &NextTableWorkload();
+  ///
+  /// Same as above for loading, which fills the tables one after another
+  /// with load_count() records in all. Thread-safe.
+  ///
+  CoreWorkload &NextLoadWorkload();
+  CoreWorkload &TableWorkload(size_t table) {
+    return tables_.empty() ? *this : *tables_[table];
+  }
+  size_t table_count() const { return tables_.empty() ? 1 : tables_.size(); }
+  uint64_t load_count() const { return load_count_; }
+  ///
+  /// Sets the record counts in p to the records there are after the phase,
+  /// including those inserted, so that a later phase on the same DB draws
+  /// its keys from all of them and inserts after them.
+  ///
+  void SaveRecordCounts(utils::Properties *p);
+  ///
+  /// Starts the clock that workloads changing over time (ramped mixes and
+  /// shifting keys) follow. Called when the client threads are released, so
+  /// that the time spent preparing the phase does not count.
+  ///
+  void StartClock();
 
   virtual std::string NextTable() { return table_name_; }
   virtual std::string NextSequenceKey();     /// Used for loading data
   virtual std::string NextTransactionKey();  /// Used for transactions
-  virtual Operation NextOperation() { return op_chooser_.Next(); }
+  virtual std::string NextInsertKey();  /// Used for inserting transactions
+  ///
+  /// Same as above, but reuse the storage of the given key, so building a
+  /// key allocates nothing once it is large enough.
+  /// @return The number of the key.
+  ///
+  virtual uint64_t NextSequenceKey(std::string *key);
+  virtual uint64_t NextTransactionKey(std::string *key);
+  virtual uint64_t NextInsertKey(std::string *key);
+  ///
+  /// Key for reads and scans, which may target or skip deleted keys.
+  ///
+  virtual uint64_t NextReadKey(std::string *key);
+  ///
+  /// Keys for a transaction, in ascending order of their numbers, which
+  /// replace the contents of keys and key_nums.
+  ///
+  virtual void NextTransactionKeys(std::vector<std::string> *keys,
+                                   std::vector<uint64_t> *key_nums);
+
+  ///
+  /// Track keys deleted and written again during the run. Thread-safe.
+  ///
+  void RecordDelete(uint64_t key_num) {
+    if (deleted_keys_) deleted_keys_->Set(key_num);
+  }
+  void RecordWrite(uint64_t key_num) {
+    if (deleted_keys_) deleted_keys_->Clear(key_num);
+  }
+
+  ///
+  /// Marks an insert of NextInsertKey() as done, whether or not it succeeded,
+  /// so that transactions may pick its key from now on. Thread-safe.
+  ///
+  void AcknowledgeInsert(uint64_t key_num) {
+    insert_key_sequence_.Acknowledge(key_num);
+  }
+  ///
+  /// In verify mode, stamps the values of a write of key_num with a new
+  /// version of the record, replacing them with stamped copies. Keys that
+  /// are not tracked, like those whose number is unknown, get version 0.
+  /// Thread-safe.
+  /// @return A ticket for AcknowledgeWrite().
+  ///
+  uint64_t StampValues(uint64_t key_num, const std::string &key,
+                       ValueBuffer &values);
+  ///
+  /// Same as above for a key whose number is unknown.
+  ///
+  uint64_t StampValues(const std::string &key, ValueBuffer &values);
+  ///
+  /// Marks a stamped write as done. If it succeeded and no other write of
+  /// the record was in flight when it was stamped, reads started afterwards
+  /// must not return an older version. Thread-safe.
+  ///
+  void AcknowledgeWrite(uint64_t key_num, uint64_t ticket, bool succeeded);
+  ///
+  /// Returns the oldest version of the record a read may return, or 0.
+  ///
+  uint32_t ExpectedVersion(uint64_t key_num) const {
+    return versions_ ? versions_->Expected(key_num) : 0;
+  }
+  bool verify() const { return verify_; }
+
+  virtual Operation NextOperation();
   virtual std::string NextFieldName();
+  virtual size_t NextFieldCount();
   virtual size_t NextScanLength() { return scan_len_chooser_->Next(); }
+  ///
+  /// Draws the next operation with all of its parameters, as numbers, for
+  /// writing it to an operation stream. Each written field of the operation
+  /// gets the same drawn length.
+  ///
+  virtual OpRecord NextOpRecord();
+  ///
+  /// Throws utils::Exception if a replayed record does not fit this workload,
+  /// e.g. because its stream was generated with other fieldcount or tables
+  /// properties.
+  ///
+  void CheckOpRecord(const OpRecord &record) const;
+  ///
+  /// Throws utils::Exception if the operations of this workload do not fit
+  /// the records of an operation stream, e.g. for fieldcount above 65535.
+  ///
+  void CheckForOpStream() const;
+
+  ///
+  /// Writes the key of key_num into buf, which must hold max_key_length()
+  /// bytes.
+  /// @return The length of the key.
+  ///
+  size_t BuildKey(uint64_t key_num, char *buf) const;
+  void BuildKeyName(uint64_t key_num, std::string *key) const;
+  std::string BuildKeyName(uint64_t key_num) const;
+  size_t max_key_length() const {
+    return key_length_ ? key_length_ : kMaxVariableKeyLength;
+  }
+
+  std::string FieldName(uint64_t field) {
+    return std::string("field").append(std::to_string(field));
+  }
+  ///
+  /// Returns len bytes of the value pool, sliced from it unless longer than
+  /// the pool, in which case they are made in a string of values.
+  ///
+  Slice BuildValue(size_t len, ValueBuffer &values) const;
 
   bool read_all_fields() const { return read_all_fields_; }
   bool write_all_fields() const { return write_all_fields_; }
+  int transaction_retries() const { return transaction_retries_; }
+  size_t batch_size() const { return batch_size_; }
 
   CoreWorkload()
       : field_count_(0),
         read_all_fields_(false),
         write_all_fields_(false),
+        transaction_keys_(0),
+        transaction_retries_(0),
+        batch_size_(0),
         field_len_generator_(NULL),
+        field_count_generator_(NULL),
+        value_pool_(NULL),
         key_generator_(NULL),
         key_chooser_(NULL),
         field_chooser_(NULL),
         scan_len_chooser_(NULL),
+        deleted_keys_(NULL),
+        verify_(false),
+        version_tables_(NULL),
+        own_version_tables_(NULL),
+        versions_(NULL),
+        read_deleted_proportion_(0),
+        read_skip_deleted_(false),
         insert_key_sequence_(3),
+        keys_from_latest_(false),
+        count_ops_(false),
+        ramp_mix_(false),
+        ramp_by_ops_(false),
+        ramp_length_(0),
         ordered_inserts_(true),
-        record_count_(0) {}
+        key_length_(0),
+        binary_keys_(false),
+        record_count_(0),
+        load_count_(0),
+        loaded_(0) {}
 
   virtual ~CoreWorkload() {
     if (field_len_generator_) delete field_len_generator_;
+    if (field_count_generator_) delete field_count_generator_;
+    if (value_pool_) delete value_pool_;
     if (key_generator_) delete key_generator_;
     if (key_chooser_) delete key_chooser_;
     if (field_chooser_) delete field_chooser_;
     if (scan_len_chooser_) delete scan_len_chooser_;
+    if (deleted_keys_) delete deleted_keys_;
+    if (own_version_tables_) delete own_version_tables_;
+    for (CoreWorkload *table : tables_) {
+      delete table;
+    }
   }
 
  protected:
+  static const size_t kMaxVariableKeyLength = 4 + 20;  /// "user" and digits
+  static const uint64_t kUnknownKey = ~0ULL;  /// Never tracked
+
   static Generator<uint64_t> *GetFieldLenGenerator(const utils::Properties &p);
-  std::string BuildKeyName(uint64_t key_num);
+  static Generator<uint64_t> *GetFieldCountGenerator(
+      const utils::Properties &p);
+  static Generator<uint64_t> *GetParetoGenerator(const utils::Properties &p,
+                                                 const std::string &prefix,
+                                                 uint64_t max);
+  uint64_t NextTransactionKeyNum();
+  uint64_t NextReadKeyNum();
+  ///
+  /// The shortest fixed-width key that holds any 64-bit key number.
+  ///
+  size_t MinHashedKeyLength() const {
+    return binary_keys_ ? sizeof(uint64_t) : kMaxVariableKeyLength;
+  }
+  ///
+  /// Whether key_num fits a fixed-width key without losing digits.
+  ///
+  bool KeyFits(uint64_t key_num) const {
+    if (key_length_ >= MinHashedKeyLength()) return true;
+    size_t width = binary_keys_ ? key_length_ : key_length_ - 4;
+    for (size_t i = 0; i < width; ++i) {
+      key_num /= binary_keys_ ? 256 : 10;
+    }
+    return key_num == 0;
+  }
 
   std::string table_name_;
   int field_count_;
   bool read_all_fields_;
   bool write_all_fields_;
+  size_t transaction_keys_;
+  int transaction_retries_;
+  size_t batch_size_;
+  std::vector<std::string> field_names_;
   Generator<uint64_t> *field_len_generator_;
+  Generator<uint64_t> *field_count_generator_;
+  ValuePool *value_pool_;
   Generator<uint64_t> *key_generator_;
   DiscreteGenerator<Operation> op_chooser_;
+  DiscreteGenerator<Operation> end_op_chooser_;  /// Mix ramped to, if any
   Generator<uint64_t> *key_chooser_;
   Generator<uint64_t> *field_chooser_;
   Generator<uint64_t> *scan_len_chooser_;
-  CounterGenerator insert_key_sequence_;
+  ConcurrentBitmap *deleted_keys_;  /// NULL if nothing is deleted
+  bool verify_;
+  VersionTables *version_tables_;
+  VersionTables *own_version_tables_;  /// If none were set
+  VersionTable *versions_;  /// NULL unless verifying
+  double read_deleted_proportion_;
+  bool read_skip_deleted_;
+  AcknowledgedCounterGenerator insert_key_sequence_;
+  bool keys_from_latest_;  /// key_chooser_ draws distances from the latest key
+  WorkloadClock clock_;
+  bool count_ops_;  /// Something changes by the number of operations
+  bool ramp_mix_;
+  bool ramp_by_ops_;
+  double ramp_length_;
   bool ordered_inserts_;
+  size_t key_length_;  /// 0 for variable-length keys
+  bool binary_keys_;
   size_t record_count_;
+  std::vector<CoreWorkload *> tables_;  /// Empty if there is a single table
+  DiscreteGenerator<size_t> table_chooser_;
+  std::vector<uint64_t> load_ends_;  /// Cumulative record counts of tables_
+  uint64_t load_count_;
+  std::atomic<uint64_t> loaded_;
 };
 
+inline CoreWorkload &CoreWorkload::NextTableWorkload() {
+  if (tables_.empty()) return *this;
+  return *tables_[table_chooser_.Next()];
+}
+
+inline CoreWorkload &CoreWorkload::NextLoadWorkload() {
+  if (tables_.empty()) return *this;
+  uint64_t n = loaded_.fetch_add(1, std::memory_order_relaxed);
+  size_t table = std::upper_bound(load_ends_.begin(), load_ends_.end(), n) -
+                 load_ends_.begin();
+  return *tables_[std::min(table, tables_.size() - 1)];
+}
+
+inline Operation CoreWorkload::NextOperation() {
+  if (count_ops_) clock_.CountOp();
+  if (ramp_mix_ &&
+      utils::ThreadRandom().NextDouble() <
+          clock_.Progress(ramp_by_ops_) / ramp_length_) {
+    return end_op_chooser_.Next();
+  }
+  return op_chooser_.Next();
+}
+
 inline std::string CoreWorkload::NextSequenceKey() {
   uint64_t key_num = key_generator_->Next();
   return BuildKeyName(key_num);
 }
 
-inline std::string CoreWorkload::NextTransactionKey() {
+inline uint64_t CoreWorkload::NextSequenceKey(std::string *key) {
+  uint64_t key_num = key_generator_->Next();
+  BuildKeyName(key_num, key);
+  return key_num;
+}
+
+inline uint64_t CoreWorkload::NextTransactionKeyNum() {
   uint64_t key_num;
+  if (keys_from_latest_) {
+    uint64_t latest = insert_key_sequence_.Last();
+    do {
+      key_num = key_chooser_->Next();
+    } while (key_num > latest);
+    return latest - key_num;
+  }
   do {
     key_num = key_chooser_->Next();
   } while (key_num > insert_key_sequence_.Last());
-  return BuildKeyName(key_num);
+  return key_num;
 }
 
-inline std::string CoreWorkload::BuildKeyName(uint64_t key_num) {
+inline std::string CoreWorkload::NextTransactionKey() {
+  return BuildKeyName(NextTransactionKeyNum());
+}
+
+inline uint64_t CoreWorkload::NextTransactionKey(std::string *key) {
+  uint64_t key_num = NextTransactionKeyNum();
+  BuildKeyName(key_num, key);
+  return key_num;
+}
+
+inline uint64_t CoreWorkload::NextReadKeyNum() {
+  uint64_t key_num = NextTransactionKeyNum();
+  if (!deleted_keys_) return key_num;
+  if (read_deleted_proportion_ > 0 &&
+      utils::ThreadRandom().NextDouble() < read_deleted_proportion_) {
+    // The first deleted key from the drawn one on
+    deleted_keys_->FindNext(key_num, &key_num);
+    return key_num;
+  }
+  // Bounded, in case most keys are deleted
+  for (int i = 0; read_skip_deleted_ && i < 16 && deleted_keys_->Test(key_num);
+       ++i) {
+    key_num = NextTransactionKeyNum();
+  }
+  return key_num;
+}
+
+inline uint64_t CoreWorkload::NextReadKey(std::string *key) {
+  uint64_t key_num = NextReadKeyNum();
+  BuildKeyName(key_num, key);
+  return key_num;
+}
+
+inline void CoreWorkload::NextTransactionKeys(
+    std::vector<std::string> *keys, std::vector<uint64_t> *key_nums) {
+  key_nums->resize(transaction_keys_);
+  for (uint64_t &key_num : *key_nums) {
+    key_num = NextTransactionKeyNum();
+  }
+  // In the same order in every transaction, so that locks taken in key order
+  // cannot deadlock
+  std::sort(key_nums->begin(), key_nums->end());
+  key_nums->erase(std::unique(key_nums->begin(), key_nums->end()),
+                  key_nums->end());
+  keys->resize(key_nums->size());
+  for (size_t i = 0; i < key_nums->size(); ++i) {
+    BuildKeyName((*key_nums)[i], &(*keys)[i]);
+  }
+}
+
+inline std::string CoreWorkload::NextInsertKey() {
+  // Continues after the loaded records, also when the run phase is started
+  // against a DB loaded by an earlier invocation
+  return BuildKeyName(insert_key_sequence_.Next());
+}
+
+inline uint64_t CoreWorkload::NextInsertKey(std::string *key) {
+  uint64_t key_num = insert_key_sequence_.Next();
+  BuildKeyName(key_num, key);
+  return key_num;
+}
+
+inline size_t CoreWorkload::BuildKey(uint64_t key_num, char *buf) const {
   if (!ordered_inserts_) {
     key_num = utils::Hash(key_num);
   }
-  return std::string("user").append(std::to_string(key_num));
+  if (key_length_ == 0) {
+    char digits[20];
+    size_t n = 0;
+    do {
+      digits[n++] = '0' + key_num % 10;
+      key_num /= 10;
+    } while (key_num);
+    memcpy(buf, "user", 4);
+    for (size_t i = 0; i < n; ++i) {
+      buf[4 + i] = digits[n - 1 - i];
+    }
+    return 4 + n;
+  } else if (binary_keys_) {
+    for (size_t i = key_length_; i > 0; --i) {
+      buf[i - 1] = static_cast<char>(key_num & 0xff);
+      key_num >>= 8;
+    }
+    return key_length_;
+  } else {
+    memcpy(buf, "user", 4);
+    for (size_t i = key_length_; i > 4; --i) {
+      buf[i - 1] = '0' + key_num % 10;
+      key_num /= 10;
+    }
+    return key_length_;
+  }
+}
+
+inline void CoreWorkload::BuildKeyName(uint64_t key_num,
+                                       std::string *key) const {
+  key->resize(max_key_length());
+  key->resize(BuildKey(key_num, &(*key)[0]));
+}
+
+inline std::string CoreWorkload::BuildKeyName(uint64_t key_num) const {
+  std::string key;
+  BuildKeyName(key_num, &key);
+  return key;
+}
+
+inline Slice CoreWorkload::BuildValue(size_t len, ValueBuffer &values) const {
+  if (len <= value_pool_->size()) return Slice(value_pool_->Next(len), len);
+  // Longer than the pool
+  std::string *value = values.NewValue();
+  while (value->size() < len) {
+    size_t chunk = std::min(len - value->size(), value_pool_->size());
+    value->append(value_pool_->Next(chunk), chunk);
+  }
+  return *value;
+}
+
+inline uint64_t CoreWorkload::StampValues(
+    uint64_t key_num, const std::string &key, ValueBuffer &values) {
+  if (!verify_) return 0;
+  uint64_t ticket = versions_->Stamp(key_num);
+  uint32_t version = static_cast<uint32_t>(ticket);
+  for (size_t i = 0; i < values.size(); ++i) {
+    // The value may be a slice of the pool, so it is stamped in a copy
+    std::string *value = values.NewValue();
+    value->assign(values[i].second.data(), values[i].second.size());
+    StampValue(ValueSeed(key, values[i].first), version, value);
+    values.SetValue(i, *value);
+  }
+  return ticket;
+}
+
+inline uint64_t CoreWorkload::StampValues(const std::string &key,
+                                          ValueBuffer &values) {
+  return StampValues(kUnknownKey, key, values);
+}
+
+inline void CoreWorkload::AcknowledgeWrite(uint64_t key_num, uint64_t ticket,
+                                           bool succeeded) {
+  if (versions_) versions_->Acknowledge(key_num, ticket, succeeded);
 }
 
 inline std::string CoreWorkload::NextFieldName() {
-  return std::string("field").append(std::to_string(field_chooser_->Next()));
+  return field_names_[field_chooser_->Next()];
+}
+
+inline size_t CoreWorkload::NextFieldCount() {
+  uint64_t count = field_count_generator_->Next();
+  return std::max<uint64_t>(1, std::min<uint64_t>(count, field_count_));
 }
 
 }  // namespace ycsbc
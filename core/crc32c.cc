@@ -0,0 +1,76 @@
+//
+//  crc32c.cc
+//  YCSB-C
+//
+
+#include "crc32c.h"
+
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+namespace {
+
+const uint32_t kPolynomial = 0x82f63b78;  // Castagnoli, reflected
+
+struct Table {
+  Table() {
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t crc = i;
+      for (int bit = 0; bit < 8; ++bit) {
+        crc = (crc >> 1) ^ (crc & 1 ? kPolynomial : 0);
+      }
+      entries[i] = crc;
+    }
+  }
+  uint32_t entries[256];
+};
+
+uint32_t ExtendPortable(uint32_t crc, const char *data, size_t n) {
+  static const Table table;
+  const uint8_t *p = reinterpret_cast<const uint8_t *>(data);
+  crc = ~crc;
+  for (size_t i = 0; i < n; ++i) {
+    crc = table.entries[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2"))) uint32_t ExtendSse42(uint32_t crc,
+                                                       const char *data,
+                                                       size_t n) {
+  uint64_t crc64 = ~crc;
+  for (; n >= 8; data += 8, n -= 8) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    crc64 = _mm_crc32_u64(crc64, word);
+  }
+  uint32_t crc32 = static_cast<uint32_t>(crc64);
+  for (; n > 0; ++data, --n) {
+    crc32 = _mm_crc32_u8(crc32, static_cast<uint8_t>(*data));
+  }
+  return ~crc32;
+}
+#endif
+
+typedef uint32_t (*ExtendFunction)(uint32_t, const char *, size_t);
+
+ExtendFunction ChooseExtend() {
+#if defined(__x86_64__)
+  // Runs before main(), possibly before the CPU model is otherwise known
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse4.2")) return ExtendSse42;
+#endif
+  return ExtendPortable;
+}
+
+const ExtendFunction kExtend = ChooseExtend();
+
+}  // namespace
+
+uint32_t ycsbc::crc32c::Extend(uint32_t crc, const char *data, size_t n) {
+  return kExtend(crc, data, n);
+}
@@ -0,0 +1,31 @@
+//
+//  crc32c.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_CRC32C_H_
+#define YCSB_C_CRC32C_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace ycsbc {
+namespace crc32c {
+
+///
+/// Returns the CRC32C (Castagnoli) of data appended to the data whose CRC32C
+/// is crc. Uses the SSE4.2 crc32 instruction where the CPU has it.
+///
+uint32_t Extend(uint32_t crc, const char *data, size_t n);
+
+inline uint32_t Value(const char *data, size_t n) { return Extend(0, data, n); }
+
+inline uint32_t Value(const std::string &data) {
+  return Extend(0, data.data(), data.size());
+}
+
+}  // namespace crc32c
+}  // namespace ycsbc
+
+#endif  // YCSB_C_CRC32C_H_
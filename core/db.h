@@ -9,14 +9,20 @@
 #ifndef YCSB_C_DB_H_
 #define YCSB_C_DB_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
+#include "record_buffer.h"
+#include "slice.h"
+#include "timer.h"
+
 namespace ycsbc {
 
 class DB {
  public:
   typedef std::pair<std::string, std::string> KVPair;
+  typedef RecordBuffer::Field Field;
   static const int kOK = 0;
   static const int kErrorNoData = 1;
   static const int kErrorConflict = 2;
@@ -92,9 +98,127 @@ class DB {
   ///
   virtual int Delete(const std::string &table, const std::string &key) = 0;
 
+  ///
+  /// The slice-based API, which the client uses. Keys and values are slices
+  /// of the caller's memory, and records read are written into the caller's
+  /// reusable buffers, so that a backend can serve an operation without
+  /// allocating. Each call has the semantics of the method of the same name
+  /// above, which the default implementations fall back to.
+  ///
+  virtual int Read(const std::string &table, const Slice &key,
+                   const std::vector<std::string> *fields,
+                   RecordBuffer *result) {
+    std::vector<KVPair> values;
+    int status = Read(table, key.ToString(), fields, values);
+    result->Assign(values);
+    return status;
+  }
+
+  virtual int Scan(const std::string &table, const Slice &key,
+                   int record_count, const std::vector<std::string> *fields,
+                   ScanBuffer *result) {
+    std::vector<std::vector<KVPair>> records;
+    int status = Scan(table, key.ToString(), record_count, fields, records);
+    result->Clear();
+    for (const auto &record : records) {
+      result->Add()->Assign(record);
+    }
+    return status;
+  }
+
+  ///
+  /// Reads a batch of records in one call. Backends that can look up several
+  /// keys at once override it; by default the records are read one by one.
+  ///
+  /// @param table The name of the table.
+  /// @param keys The keys of the records to read.
+  /// @param fields The list of fields to read, or NULL for all of them.
+  /// @param result One record per key, in the order of keys. A record not
+  ///        found is empty.
+  /// @return Zero on success, even if records are missing, or a non-zero
+  ///         error code on error.
+  ///
+  virtual int MultiRead(const std::string &table,
+                        const std::vector<Slice> &keys,
+                        const std::vector<std::string> *fields,
+                        ScanBuffer *result) {
+    result->Clear();
+    for (const Slice &key : keys) {
+      RecordBuffer *record = result->Add();
+      int status = Read(table, key, fields, record);
+      if (status == kErrorNoData) {
+        record->Clear();
+      } else if (status != kOK) {
+        return status;
+      }
+    }
+    return kOK;
+  }
+
+  virtual int Update(const std::string &table, const Slice &key,
+                     const std::vector<Field> &values) {
+    std::vector<KVPair> kvs = ToKVPairs(values);
+    return Update(table, key.ToString(), kvs);
+  }
+
+  virtual int Insert(const std::string &table, const Slice &key,
+                     const std::vector<Field> &values) {
+    std::vector<KVPair> kvs = ToKVPairs(values);
+    return Insert(table, key.ToString(), kvs);
+  }
+
+  ///
+  /// Reads a set of records and writes new values to all of them in one
+  /// transaction. The default implementation reads and then updates each
+  /// record in turn, which is not atomic; backends with transactions
+  /// override it.
+  ///
+  /// @param table The name of the table.
+  /// @param keys The keys of the records, in the order locks should be taken.
+  /// @param values Field/value pairs written to each record.
+  /// @param results The records read, one per key, in the order of keys.
+  /// @param commit_ns The time spent committing, in nanoseconds.
+  /// @return Zero on commit, kErrorConflict if aborted by a conflict with
+  ///         another transaction and worth retrying, or another non-zero
+  ///         error code on error.
+  ///
+  virtual int Transaction(const std::string &table,
+                          const std::vector<std::string> &keys,
+                          const std::vector<ValueBuffer> &values,
+                          ScanBuffer *results, uint64_t *commit_ns) {
+    results->Clear();
+    for (size_t i = 0; i < keys.size(); ++i) {
+      int status = Read(table, Slice(keys[i]), NULL, results->Add());
+      if (status != kOK) return status;
+    }
+    uint64_t start = utils::NowNanos();
+    for (size_t i = 0; i < keys.size(); ++i) {
+      int status = Update(table, Slice(keys[i]), values[i].fields());
+      if (status != kOK) return status;
+    }
+    *commit_ns = utils::NowNanos() - start;
+    return kOK;
+  }
+  ///
+  /// Blocks until background work left by earlier phases (e.g. flushes and
+  /// compactions) has finished, so that the next phase starts from a settled
+  /// state. Called from the main thread between phases.
+  ///
+  virtual void WaitForBalance() {}
+
   virtual void PrintStats() = 0;
 
   virtual ~DB() {}
+
+ protected:
+  static std::vector<KVPair> ToKVPairs(const std::vector<Field> &fields) {
+    std::vector<KVPair> kvs;
+    kvs.reserve(fields.size());
+    for (const Field &field : fields) {
+      kvs.emplace_back(field.first.ToString(), field.second.ToString());
+    }
+    return kvs;
+  }
 };
 
 }  // namespace ycsbc
@@ -11,7 +11,6 @@
 
 #include <atomic>
 #include <cassert>
-#include <mutex>
 #include <vector>
 
 #include "generator.h"
@@ -26,13 +25,12 @@ class DiscreteGenerator : public Generator<Value> {
   void AddValue(Value value, double weight);
 
   Value Next();
-  Value Last() { return last_; }
+  Value Last() { return last_.load(std::memory_order_relaxed); }
 
  private:
   std::vector<std::pair<Value, double>> values_;
   double sum_;
   std::atomic<Value> last_;
-  std::mutex mutex_;
 };
 
 template <typename Value>
@@ -46,19 +44,18 @@ inline void DiscreteGenerator<Value>::AddValue(Value value, double weight) {
 
 template <typename Value>
 inline Value DiscreteGenerator<Value>::Next() {
-  mutex_.lock();
   double chooser = utils::RandomDouble();
-  mutex_.unlock();
 
   for (auto p = values_.cbegin(); p != values_.cend(); ++p) {
     if (chooser < p->second / sum_) {
-      return last_ = p->first;
+      last_.store(p->first, std::memory_order_relaxed);
+      return p->first;
     }
     chooser -= p->second / sum_;
   }
 
   assert(false);
-  return last_;
+  return Last();
 }
 
 }  // namespace ycsbc
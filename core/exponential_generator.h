@@ -0,0 +1,47 @@
+//
+//  exponential_generator.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_EXPONENTIAL_GENERATOR_H_
+#define YCSB_C_EXPONENTIAL_GENERATOR_H_
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+#include "generator.h"
+#include "utils.h"
+
+namespace ycsbc {
+
+///
+/// Exponentially distributed values, scaled so that the given percentile of
+/// them falls below range. Used as distances back from the latest key.
+///
+class ExponentialGenerator : public Generator<uint64_t> {
+ public:
+  ExponentialGenerator(double percentile, double range)
+      : gamma_(-std::log(1.0 - percentile / 100.0) / range) {
+    Next();
+  }
+
+  uint64_t Next();
+  uint64_t Last() { return last_.load(std::memory_order_relaxed); }
+
+ private:
+  const double gamma_;
+  std::atomic<uint64_t> last_;
+};
+
+inline uint64_t ExponentialGenerator::Next() {
+  // 1 - u is in (0, 1], so the logarithm is finite
+  double u = 1.0 - utils::ThreadRandom().NextDouble();
+  uint64_t value = static_cast<uint64_t>(-std::log(u) / gamma_);
+  last_.store(value, std::memory_order_relaxed);
+  return value;
+}
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_EXPONENTIAL_GENERATOR_H_
@@ -0,0 +1,182 @@
+//
+//  histogram.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_HISTOGRAM_H_
+#define YCSB_C_HISTOGRAM_H_
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+namespace ycsbc {
+
+///
+/// Log-linear bucketed latency histogram in the style of HdrHistogram.
+/// Every power of two is split into kSubBuckets / 2 linear sub-buckets, so a
+/// recorded value is kept with a relative error below 2 / kSubBuckets.
+///
+/// A histogram has a single writer (the owning client thread). Counters are
+/// atomics updated with relaxed load/store, so other threads may read or merge
+/// it at any time without locking and without slowing down the writer.
+///
+class Histogram {
+ public:
+  static const int kSubBucketBits = 7;
+  static const uint64_t kSubBuckets = 1 << kSubBucketBits;
+  static const int kNumBuckets =
+      (64 - kSubBucketBits + 1) * (kSubBuckets / 2) + kSubBuckets / 2;
+
+  Histogram() { Reset(); }
+
+  void Record(uint64_t value);
+  void Merge(const Histogram &other);
+  ///
+  /// Removes the samples of an earlier snapshot of this histogram, leaving
+  /// the samples recorded since. Min and max are narrowed to the bounds of
+  /// the remaining non-empty buckets.
+  ///
+  void Subtract(const Histogram &earlier);
+  void Reset();
+
+  uint64_t Count() const { return count_.load(std::memory_order_relaxed); }
+  uint64_t Min() const;
+  uint64_t Max() const { return max_.load(std::memory_order_relaxed); }
+  double Mean() const;
+  ///
+  /// Returns the highest value equivalent to the recorded value at the
+  /// given percentile (0 < percentile <= 100).
+  ///
+  uint64_t ValueAtPercentile(double percentile) const;
+
+ private:
+  static int BucketIndex(uint64_t value);
+  static uint64_t BucketHighest(int index);
+
+  static void Add(std::atomic<uint64_t> &counter, uint64_t delta) {
+    counter.store(counter.load(std::memory_order_relaxed) + delta,
+                  std::memory_order_relaxed);
+  }
+
+  std::atomic<uint64_t> counts_[kNumBuckets];
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> sum_;
+  std::atomic<uint64_t> min_;
+  std::atomic<uint64_t> max_;
+};
+
+inline int Histogram::BucketIndex(uint64_t value) {
+  if (value < kSubBuckets) return static_cast<int>(value);
+  int msb = 63 - __builtin_clzll(value);
+  int shift = msb - (kSubBucketBits - 1);
+  return shift * static_cast<int>(kSubBuckets / 2) +
+         static_cast<int>(value >> shift);
+}
+
+inline uint64_t Histogram::BucketHighest(int index) {
+  if (index < static_cast<int>(kSubBuckets)) return index;
+  int shift = index / static_cast<int>(kSubBuckets / 2) - 1;
+  uint64_t sub = index - shift * (kSubBuckets / 2);
+  return ((sub + 1) << shift) - 1;
+}
+
+inline void Histogram::Record(uint64_t value) {
+  Add(counts_[BucketIndex(value)], 1);
+  Add(count_, 1);
+  Add(sum_, value);
+  if (value < min_.load(std::memory_order_relaxed)) {
+    min_.store(value, std::memory_order_relaxed);
+  }
+  if (value > max_.load(std::memory_order_relaxed)) {
+    max_.store(value, std::memory_order_relaxed);
+  }
+}
+
+inline void Histogram::Merge(const Histogram &other) {
+  for (int i = 0; i < kNumBuckets; ++i) {
+    uint64_t n = other.counts_[i].load(std::memory_order_relaxed);
+    if (n) Add(counts_[i], n);
+  }
+  Add(count_, other.count_.load(std::memory_order_relaxed));
+  Add(sum_, other.sum_.load(std::memory_order_relaxed));
+  uint64_t other_min = other.min_.load(std::memory_order_relaxed);
+  if (other_min < min_.load(std::memory_order_relaxed)) {
+    min_.store(other_min, std::memory_order_relaxed);
+  }
+  uint64_t other_max = other.max_.load(std::memory_order_relaxed);
+  if (other_max > max_.load(std::memory_order_relaxed)) {
+    max_.store(other_max, std::memory_order_relaxed);
+  }
+}
+
+inline void Histogram::Subtract(const Histogram &earlier) {
+  int lowest = -1, highest = -1;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    uint64_t n = counts_[i].load(std::memory_order_relaxed) -
+                 earlier.counts_[i].load(std::memory_order_relaxed);
+    counts_[i].store(n, std::memory_order_relaxed);
+    if (n) {
+      if (lowest < 0) lowest = i;
+      highest = i;
+    }
+  }
+  count_.store(Count() - earlier.Count(), std::memory_order_relaxed);
+  sum_.store(sum_.load(std::memory_order_relaxed) -
+                 earlier.sum_.load(std::memory_order_relaxed),
+             std::memory_order_relaxed);
+  if (lowest < 0) {
+    min_.store(UINT64_MAX, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+    return;
+  }
+  uint64_t low = lowest ? BucketHighest(lowest - 1) + 1 : 0;
+  if (low > min_.load(std::memory_order_relaxed)) {
+    min_.store(low, std::memory_order_relaxed);
+  }
+  if (BucketHighest(highest) < Max()) {
+    max_.store(BucketHighest(highest), std::memory_order_relaxed);
+  }
+}
+
+inline void Histogram::Reset() {
+  for (int i = 0; i < kNumBuckets; ++i) {
+    counts_[i].store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  sum_.store(0, std::memory_order_relaxed);
+  min_.store(UINT64_MAX, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+inline uint64_t Histogram::Min() const {
+  return Count() ? min_.load(std::memory_order_relaxed) : 0;
+}
+
+inline double Histogram::Mean() const {
+  uint64_t n = Count();
+  return n ? static_cast<double>(sum_.load(std::memory_order_relaxed)) / n
+           : 0.0;
+}
+
+inline uint64_t Histogram::ValueAtPercentile(double percentile) const {
+  uint64_t total = Count();
+  if (total == 0) return 0;
+  uint64_t rank = static_cast<uint64_t>(std::ceil(percentile / 100.0 * total));
+  if (rank < 1) rank = 1;
+  if (rank > total) rank = total;
+
+  uint64_t seen = 0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    seen += counts_[i].load(std::memory_order_relaxed);
+    if (seen >= rank) {
+      uint64_t value = BucketHighest(i);
+      return value < Max() ? value : Max();
+    }
+  }
+  return Max();
+}
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_HISTOGRAM_H_
@@ -0,0 +1,153 @@
+//
+//  histogram_generator.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_HISTOGRAM_GENERATOR_H_
+#define YCSB_C_HISTOGRAM_GENERATOR_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "generator.h"
+#include "utils.h"
+
+namespace ycsbc {
+
+///
+/// Draws values from an empirical histogram, e.g. of the value sizes of a
+/// production workload, in constant time with Vose's alias method.
+///
+/// The histogram is a text file of one bin per line: "value weight" for a
+/// single value, or "min max weight" for a range whose values are all equally
+/// likely. Columns are separated by whitespace or commas, and lines starting
+/// with '#' are skipped. Weights need not add up to anything.
+///
+class HistogramGenerator : public Generator<uint64_t> {
+ public:
+  explicit HistogramGenerator(const std::string &path);
+
+  uint64_t Next();
+  uint64_t Last() { return last_.load(std::memory_order_relaxed); }
+
+ private:
+  struct Bin {
+    uint64_t min;
+    uint64_t width;      /// Number of values in the bin
+    double probability;  /// Of the bin itself in its slot of the table
+    uint32_t alias;      /// Bin drawn for the rest of the slot
+  };
+
+  void BuildAliasTable(const std::vector<double> &weights);
+
+  std::vector<Bin> bins_;
+  std::atomic<uint64_t> last_;
+};
+
+inline HistogramGenerator::HistogramGenerator(const std::string &path) {
+  std::ifstream input(path);
+  if (!input.is_open()) {
+    throw utils::Exception(path + ": cannot open histogram");
+  }
+  std::vector<double> weights;
+  std::string line;
+  for (uint64_t line_num = 1; std::getline(input, line); ++line_num) {
+    std::replace(line.begin(), line.end(), ',', ' ');
+    std::istringstream columns(line);
+    std::vector<std::string> fields;
+    std::string field;
+    while (columns >> field) {
+      fields.push_back(field);
+    }
+    if (fields.empty() || fields[0][0] == '#') continue;
+
+    Bin bin;
+    double weight = -1;
+    try {
+      if (fields.size() == 2 || fields.size() == 3) {
+        bin.min = std::stoull(fields[0]);
+        uint64_t max = fields.size() == 3 ? std::stoull(fields[1]) : bin.min;
+        bin.width = max >= bin.min ? max - bin.min + 1 : 0;
+        weight = std::stod(fields.back());
+      }
+    } catch (const std::exception &) {
+      weight = -1;
+    }
+    // std::stod takes "nan" and "inf" too, which would spoil the alias table
+    if (!std::isfinite(weight) || weight < 0 || bin.width == 0) {
+      throw utils::Exception(path + ":" + std::to_string(line_num) +
+                             ": malformed histogram bin");
+    }
+    if (weight == 0) continue;
+    bins_.push_back(bin);
+    weights.push_back(weight);
+  }
+  if (bins_.empty()) {
+    throw utils::Exception(path + ": empty histogram");
+  }
+  double sum = 0;
+  for (double weight : weights) {
+    sum += weight;
+  }
+  if (!std::isfinite(sum)) {
+    throw utils::Exception(path + ": histogram weights add up to infinity");
+  }
+  BuildAliasTable(weights);
+  Next();
+}
+
+inline void HistogramGenerator::BuildAliasTable(
+    const std::vector<double> &weights) {
+  const size_t n = bins_.size();
+  double sum = 0;
+  for (double weight : weights) {
+    sum += weight;
+  }
+  // Scaled so that the average slot holds 1
+  std::vector<double> scaled(n);
+  std::vector<uint32_t> small, large;
+  for (size_t i = 0; i < n; ++i) {
+    scaled[i] = weights[i] * n / sum;
+    (scaled[i] < 1 ? small : large).push_back(i);
+  }
+  while (!small.empty() && !large.empty()) {
+    uint32_t less = small.back();
+    uint32_t more = large.back();
+    small.pop_back();
+    large.pop_back();
+    bins_[less].probability = scaled[less];
+    bins_[less].alias = more;
+    // The slot of less is topped up from more
+    scaled[more] -= 1 - scaled[less];
+    (scaled[more] < 1 ? small : large).push_back(more);
+  }
+  // Left over only by rounding errors, each fills its own slot
+  for (uint32_t i : small) {
+    bins_[i].probability = 1;
+    bins_[i].alias = i;
+  }
+  for (uint32_t i : large) {
+    bins_[i].probability = 1;
+    bins_[i].alias = i;
+  }
+}
+
+inline uint64_t HistogramGenerator::Next() {
+  utils::Random &random = utils::ThreadRandom();
+  const Bin &slot = bins_[random.Uniform(bins_.size())];
+  const Bin &bin =
+      random.NextDouble() < slot.probability ? slot : bins_[slot.alias];
+  uint64_t value = bin.min + random.Uniform(bin.width);
+  last_.store(value, std::memory_order_relaxed);
+  return value;
+}
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_HISTOGRAM_GENERATOR_H_
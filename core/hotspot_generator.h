@@ -0,0 +1,65 @@
+//
+//  hotspot_generator.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_HOTSPOT_GENERATOR_H_
+#define YCSB_C_HOTSPOT_GENERATOR_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+#include "generator.h"
+#include "utils.h"
+
+namespace ycsbc {
+
+///
+/// Picks from a hot set at the low end of the range with a given probability,
+/// and uniformly from the rest of the range otherwise. Within the hot set and
+/// the cold set, all values are equally likely.
+///
+class HotspotGenerator : public Generator<uint64_t> {
+ public:
+  // Both min and max are inclusive
+  HotspotGenerator(uint64_t min, uint64_t max, double hot_set_fraction,
+                   double hot_op_fraction)
+      : min_(min),
+        hot_items_(std::max<uint64_t>(
+            1, (max - min + 1) * Clamp(hot_set_fraction))),
+        cold_items_(max - min + 1 - hot_items_),
+        hot_op_fraction_(cold_items_ ? Clamp(hot_op_fraction) : 1.0) {
+    Next();
+  }
+
+  uint64_t Next();
+  uint64_t Last() { return last_.load(std::memory_order_relaxed); }
+
+ private:
+  static double Clamp(double fraction) {
+    return std::min(std::max(fraction, 0.0), 1.0);
+  }
+
+  const uint64_t min_;
+  const uint64_t hot_items_;
+  const uint64_t cold_items_;
+  const double hot_op_fraction_;
+  std::atomic<uint64_t> last_;
+};
+
+inline uint64_t HotspotGenerator::Next() {
+  utils::Random &random = utils::ThreadRandom();
+  uint64_t value;
+  if (random.NextDouble() < hot_op_fraction_) {
+    value = min_ + random.Uniform(hot_items_);
+  } else {
+    value = min_ + hot_items_ + random.Uniform(cold_items_);
+  }
+  last_.store(value, std::memory_order_relaxed);
+  return value;
+}
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_HOTSPOT_GENERATOR_H_
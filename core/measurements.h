@@ -0,0 +1,93 @@
+//
+//  measurements.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_MEASUREMENTS_H_
+#define YCSB_C_MEASUREMENTS_H_
+
+#include <cinttypes>
+#include <cstdio>
+#include <string>
+
+#include "core_workload.h"
+#include "histogram.h"
+
+namespace ycsbc {
+
+///
+/// Latency histograms (in nanoseconds) of one client thread, one per
+/// operation type. Each thread owns its own instance; the main thread merges
+/// them once the phase is over.
+///
+class Measurements {
+ public:
+  void Record(Operation op, uint64_t latency_ns) {
+    histograms_[op].Record(latency_ns);
+  }
+
+  const Histogram &Get(Operation op) const { return histograms_[op]; }
+
+  void Merge(const Measurements &other) {
+    for (int i = 0; i < kNumOperations; ++i) {
+      histograms_[i].Merge(other.histograms_[i]);
+    }
+  }
+
+  void Subtract(const Measurements &earlier) {
+    for (int i = 0; i < kNumOperations; ++i) {
+      histograms_[i].Subtract(earlier.histograms_[i]);
+    }
+  }
+
+  ///
+  /// Number of operations measured, over all operation types.
+  ///
+  uint64_t Count() const {
+    uint64_t count = 0;
+    for (int i = 0; i < kNumOperations; ++i) {
+      count += histograms_[i].Count();
+    }
+    return count;
+  }
+
+  void Reset() {
+    for (int i = 0; i < kNumOperations; ++i) {
+      histograms_[i].Reset();
+    }
+  }
+
+  ///
+  /// One line per operation type that has been measured, latencies in us.
+  ///
+  std::string Summary() const;
+
+ private:
+  Histogram histograms_[kNumOperations];
+};
+
+inline std::string Measurements::Summary() const {
+  std::string str;
+  char buf[512];
+  for (int i = 0; i < kNumOperations; ++i) {
+    const Histogram &h = histograms_[i];
+    if (h.Count() == 0) continue;
+    snprintf(buf, sizeof(buf),
+             "%-16s count: %" PRIu64
+             "  min: %.2f  avg: %.2f  p50: %.2f  p90: %.2f  "
+             "p99: %.2f  p99.9: %.2f  p99.99: %.2f  max: %.2f (us)\n",
+             OperationName(static_cast<Operation>(i)), h.Count(),
+             h.Min() / 1000.0, h.Mean() / 1000.0,
+             h.ValueAtPercentile(50) / 1000.0,
+             h.ValueAtPercentile(90) / 1000.0,
+             h.ValueAtPercentile(99) / 1000.0,
+             h.ValueAtPercentile(99.9) / 1000.0,
+             h.ValueAtPercentile(99.99) / 1000.0, h.Max() / 1000.0);
+    str.append(buf);
+  }
+  return str;
+}
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_MEASUREMENTS_H_
@@ -0,0 +1,105 @@
+//
+//  op_stream.cc
+//  YCSB-C
+//
+
+#include "op_stream.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+
+#include "utils.h"
+
+using std::string;
+using ycsbc::OpRecord;
+using ycsbc::OpStreamReader;
+using ycsbc::OpStreamWriter;
+
+namespace {
+
+const char kMagic[8] = {'Y', 'C', 'S', 'B', 'O', 'P', 'S', '1'};
+
+struct Header {
+  char magic[8];
+  uint64_t count;
+};
+
+static_assert(sizeof(Header) == 16, "Header must be packed");
+
+utils::Exception Error(const string &path, const char *what) {
+  return utils::Exception(path + ": " + what + ": " + strerror(errno));
+}
+
+}  // namespace
+
+OpStreamWriter::OpStreamWriter(const string &path)
+    : path_(path), file_(fopen(path.c_str(), "wb")), count_(0) {
+  if (!file_) throw Error(path_, "cannot create operation stream");
+  // The count is filled in on Close()
+  Header header;
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.count = 0;
+  if (fwrite(&header, sizeof(header), 1, file_) != 1) {
+    throw Error(path_, "cannot write operation stream");
+  }
+}
+
+OpStreamWriter::~OpStreamWriter() {
+  if (file_) fclose(file_);
+}
+
+void OpStreamWriter::Append(const OpRecord &record) {
+  if (fwrite(&record, sizeof(record), 1, file_) != 1) {
+    throw Error(path_, "cannot write operation stream");
+  }
+  ++count_;
+}
+
+void OpStreamWriter::Close() {
+  if (fseek(file_, offsetof(Header, count), SEEK_SET) != 0 ||
+      fwrite(&count_, sizeof(count_), 1, file_) != 1 || fclose(file_) != 0) {
+    file_ = NULL;
+    throw Error(path_, "cannot write operation stream");
+  }
+  file_ = NULL;
+}
+
+OpStreamReader::OpStreamReader(const string &path)
+    : map_(MAP_FAILED), map_size_(0), records_(NULL), count_(0) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) throw Error(path, "cannot open operation stream");
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    throw Error(path, "cannot open operation stream");
+  }
+  map_size_ = st.st_size;
+  if (map_size_ < sizeof(Header)) {
+    close(fd);
+    throw utils::Exception(path + ": not a complete operation stream");
+  }
+  map_ = mmap(NULL, map_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map_ == MAP_FAILED) throw Error(path, "cannot map operation stream");
+
+  const Header *header = static_cast<const Header *>(map_);
+  if (memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 ||
+      header->count > (map_size_ - sizeof(Header)) / sizeof(OpRecord)) {
+    munmap(map_, map_size_);
+    throw utils::Exception(path + ": not a complete operation stream");
+  }
+  count_ = header->count;
+  records_ = reinterpret_cast<const OpRecord *>(header + 1);
+  // Threads claim the records in increasing order
+  madvise(map_, map_size_, MADV_SEQUENTIAL);
+}
+
+OpStreamReader::~OpStreamReader() {
+  if (map_ != MAP_FAILED) munmap(map_, map_size_);
+}
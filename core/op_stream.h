@@ -0,0 +1,82 @@
+//
+//  op_stream.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_OP_STREAM_H_
+#define YCSB_C_OP_STREAM_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace ycsbc {
+
+///
+/// One pre-generated operation. Keys and fields are kept as numbers, so the
+/// record has a fixed size and the strings are only built when it is replayed.
+///
+struct OpRecord {
+  uint64_t key;           /// Key number, before it is hashed
+  uint32_t scan_length;   /// Scans only
+  uint32_t value_length;  /// Length of each field written
+  uint16_t field;         /// Field read or updated if not all fields are
+  uint8_t op;             /// Operation
+  uint8_t table;          /// Index of the table, if there are several
+  uint16_t field_count;   /// Fields of a record written, 0 for fieldcount
+  uint8_t reserved[2];
+};
+
+static_assert(sizeof(OpRecord) == 24, "OpRecord must be packed");
+
+///
+/// Writes an operation stream file: a 16-byte header (magic and number of
+/// records) followed by the records in native byte order.
+///
+class OpStreamWriter {
+ public:
+  explicit OpStreamWriter(const std::string &path);
+  ~OpStreamWriter();
+
+  void Append(const OpRecord &record);
+  ///
+  /// Completes the header and closes the file.
+  ///
+  void Close();
+
+  uint64_t count() const { return count_; }
+
+ private:
+  OpStreamWriter(const OpStreamWriter &) = delete;
+  OpStreamWriter &operator=(const OpStreamWriter &) = delete;
+
+  std::string path_;
+  FILE *file_;
+  uint64_t count_;
+};
+
+///
+/// Maps an operation stream file read-only into memory. Records can be read
+/// by any number of threads at once, without copying.
+///
+class OpStreamReader {
+ public:
+  explicit OpStreamReader(const std::string &path);
+  ~OpStreamReader();
+
+  uint64_t size() const { return count_; }
+  const OpRecord &operator[](uint64_t i) const { return records_[i]; }
+
+ private:
+  OpStreamReader(const OpStreamReader &) = delete;
+  OpStreamReader &operator=(const OpStreamReader &) = delete;
+
+  void *map_;
+  size_t map_size_;
+  const OpRecord *records_;
+  uint64_t count_;
+};
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_OP_STREAM_H_
@@ -0,0 +1,79 @@
+//
+//  pacer.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_PACER_H_
+#define YCSB_C_PACER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <thread>
+
+#include "timer.h"
+
+namespace ycsbc {
+
+///
+/// Open-loop arrival schedule of one client thread. Operations are scheduled
+/// at a fixed interval or with exponentially distributed gaps (a Poisson
+/// process) at the given rate, independent of how long earlier operations
+/// took. When the thread falls behind, operations are issued back to back
+/// until it catches up with the schedule.
+///
+class Pacer {
+ public:
+  static const uint64_t kSpinNanos = 100000;
+
+  Pacer(double ops_per_sec, bool poisson, uint64_t seed = 0)
+      : interval_ns_(1e9 / ops_per_sec),
+        poisson_(poisson),
+        gap_(1.0 / interval_ns_),
+        generator_(seed),
+        start_ns_(0),
+        offset_ns_(0) {}
+
+  ///
+  /// Blocks until the next scheduled operation is due.
+  /// @return The intended start time of that operation in nanoseconds.
+  ///
+  uint64_t Next();
+
+  ///
+  /// Blocks until the given time in nanoseconds.
+  ///
+  static void WaitUntil(uint64_t ns);
+
+ private:
+  double interval_ns_;
+  bool poisson_;
+  std::exponential_distribution<double> gap_;
+  std::mt19937_64 generator_;
+  uint64_t start_ns_;
+  double offset_ns_;  /// Schedule of the next operation relative to start_ns_
+};
+
+inline uint64_t Pacer::Next() {
+  if (start_ns_ == 0) start_ns_ = utils::NowNanos();
+  uint64_t intended = start_ns_ + static_cast<uint64_t>(offset_ns_);
+  offset_ns_ += poisson_ ? gap_(generator_) : interval_ns_;
+  WaitUntil(intended);
+  return intended;
+}
+
+inline void Pacer::WaitUntil(uint64_t ns) {
+  // Sleeping overshoots by tens of microseconds, which would show up as
+  // queueing delay; sleep only for the bulk of the wait and spin the rest
+  uint64_t now = utils::NowNanos();
+  if (ns > now + kSpinNanos) {
+    std::this_thread::sleep_for(
+        std::chrono::nanoseconds(ns - now - kSpinNanos));
+  }
+  while (utils::NowNanos() < ns) {
+  }
+}
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_PACER_H_
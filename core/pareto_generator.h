@@ -0,0 +1,67 @@
+//
+//  pareto_generator.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_PARETO_GENERATOR_H_
+#define YCSB_C_PARETO_GENERATOR_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+#include "generator.h"
+#include "utils.h"
+
+namespace ycsbc {
+
+///
+/// Values of a generalized Pareto distribution, rounded and clamped to
+/// [min, max]. This is the model fitted to the value sizes of production
+/// RocksDB workloads, and used for them by db_bench's mixgraph benchmark.
+///
+class ParetoGenerator : public Generator<uint64_t> {
+ public:
+  // Both min and max are inclusive
+  ParetoGenerator(double location, double scale, double shape, uint64_t min,
+                  uint64_t max)
+      : location_(location),
+        scale_(scale),
+        shape_(shape),
+        min_(min),
+        max_(std::max(min, max)) {
+    Next();
+  }
+
+  uint64_t Next();
+  uint64_t Last() { return last_.load(std::memory_order_relaxed); }
+
+ private:
+  const double location_;
+  const double scale_;
+  const double shape_;
+  const uint64_t min_;
+  const uint64_t max_;
+  std::atomic<uint64_t> last_;
+};
+
+inline uint64_t ParetoGenerator::Next() {
+  // Inverse of the CDF; 1 - u is in (0, 1], so the result is finite
+  double u = 1.0 - utils::ThreadRandom().NextDouble();
+  double x = shape_ == 0
+                 ? location_ - scale_ * std::log(u)
+                 : location_ + scale_ * (std::pow(u, -shape_) - 1) / shape_;
+  uint64_t value = min_;
+  if (x >= max_) {
+    value = max_;
+  } else if (x > min_) {
+    value = static_cast<uint64_t>(x + 0.5);
+  }
+  last_.store(value, std::memory_order_relaxed);
+  return value;
+}
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_PARETO_GENERATOR_H_
@@ -0,0 +1,177 @@
+//
+//  record_buffer.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_RECORD_BUFFER_H_
+#define YCSB_C_RECORD_BUFFER_H_
+
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "slice.h"
+
+namespace ycsbc {
+
+///
+/// A record read through the slice-based DB API. The buffer owns a copy of
+/// the bytes of the record, and its fields are slices into them. It keeps
+/// its capacity when cleared, so a buffer reused for every read stops
+/// allocating once it has grown to the largest record.
+///
+/// Fields point into the buffer itself, so it can be neither copied nor
+/// moved.
+///
+class RecordBuffer {
+ public:
+  typedef std::pair<Slice, Slice> Field;
+
+  RecordBuffer() : corrupted_(false) {}
+  RecordBuffer(const RecordBuffer &) = delete;
+  RecordBuffer &operator=(const RecordBuffer &) = delete;
+
+  void Clear() {
+    data_.clear();
+    fields_.clear();
+    corrupted_ = false;
+  }
+
+  ///
+  /// Replaces the record with a copy of size bytes at data, with no fields
+  /// yet. Fields added next may point into data().
+  ///
+  void SetData(const char *data, size_t size) {
+    fields_.clear();
+    corrupted_ = false;
+    data_.assign(data, size);
+  }
+
+  ///
+  /// Replaces the record with a copy of owned field/value pairs.
+  ///
+  void Assign(const std::vector<std::pair<std::string, std::string>> &kvs);
+
+  void AddField(const Slice &name, const Slice &value) {
+    fields_.emplace_back(name, value);
+  }
+
+  ///
+  /// Marks the record as read but not decodable into fields, which verify
+  /// mode counts as corrupted. The record is left with no fields.
+  ///
+  void SetCorrupted() {
+    fields_.clear();
+    corrupted_ = true;
+  }
+  bool corrupted() const { return corrupted_; }
+
+  const char *data() const { return data_.data(); }
+  size_t data_size() const { return data_.size(); }
+  const std::vector<Field> &fields() const { return fields_; }
+  bool empty() const { return fields_.empty(); }
+
+ private:
+  std::string data_;
+  std::vector<Field> fields_;
+  bool corrupted_;
+};
+
+///
+/// The records of a scan or a batched read. Buffers are kept for reuse when
+/// cleared and never move, so slices into them stay valid until the next
+/// Clear.
+///
+class ScanBuffer {
+ public:
+  ScanBuffer() : size_(0) {}
+
+  void Clear() { size_ = 0; }
+
+  ///
+  /// Appends an empty record and returns it.
+  ///
+  RecordBuffer *Add() {
+    if (size_ == records_.size()) records_.emplace_back();
+    RecordBuffer *record = &records_[size_++];
+    record->Clear();
+    return record;
+  }
+
+  size_t size() const { return size_; }
+  const RecordBuffer &operator[](size_t i) const { return records_[i]; }
+
+ private:
+  std::deque<RecordBuffer> records_;  /// Grows at the end without moving
+  size_t size_;
+};
+
+///
+/// The fields of a record or an update to write through the slice-based DB
+/// API. Names and values are slices of bytes owned elsewhere, like the field
+/// names and the value pool of a workload, so that building them copies
+/// nothing. Values that have to be made or changed live in strings of the
+/// buffer, which are kept for reuse when cleared and never move.
+///
+class ValueBuffer {
+ public:
+  typedef RecordBuffer::Field Field;
+
+  ValueBuffer() : num_values_(0) {}
+  ValueBuffer(ValueBuffer &&) = default;
+  ValueBuffer(const ValueBuffer &) = delete;
+  ValueBuffer &operator=(const ValueBuffer &) = delete;
+
+  void Clear() {
+    fields_.clear();
+    num_values_ = 0;
+  }
+
+  void Add(const Slice &name, const Slice &value) {
+    fields_.emplace_back(name, value);
+  }
+  ///
+  /// Returns an empty string owned by the buffer for a value to be made in.
+  /// It stays valid until the next Clear.
+  ///
+  std::string *NewValue() {
+    if (num_values_ == values_.size()) values_.emplace_back();
+    std::string *value = &values_[num_values_++];
+    value->clear();
+    return value;
+  }
+  void SetValue(size_t i, const Slice &value) { fields_[i].second = value; }
+
+  const std::vector<Field> &fields() const { return fields_; }
+  size_t size() const { return fields_.size(); }
+  const Field &operator[](size_t i) const { return fields_[i]; }
+
+ private:
+  std::vector<Field> fields_;
+  std::deque<std::string> values_;  /// Grows at the end without moving
+  size_t num_values_;
+};
+
+inline void RecordBuffer::Assign(
+    const std::vector<std::pair<std::string, std::string>> &kvs) {
+  fields_.clear();
+  data_.clear();
+  corrupted_ = false;
+  for (const auto &kv : kvs) {
+    data_.append(kv.first);
+    data_.append(kv.second);
+  }
+  // Only once the data has stopped growing can slices point into it
+  const char *p = data_.data();
+  for (const auto &kv : kvs) {
+    Slice name(p, kv.first.size());
+    p += kv.first.size();
+    fields_.emplace_back(name, Slice(p, kv.second.size()));
+    p += kv.second.size();
+  }
+}
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_RECORD_BUFFER_H_
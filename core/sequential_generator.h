@@ -0,0 +1,44 @@
+//
+//  sequential_generator.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_SEQUENTIAL_GENERATOR_H_
+#define YCSB_C_SEQUENTIAL_GENERATOR_H_
+
+#include <atomic>
+#include <cstdint>
+
+#include "generator.h"
+
+namespace ycsbc {
+
+///
+/// Cycles through the range in order, shared by all threads.
+///
+class SequentialGenerator : public Generator<uint64_t> {
+ public:
+  // Both min and max are inclusive
+  SequentialGenerator(uint64_t min, uint64_t max)
+      : min_(min), num_items_(max - min + 1), counter_(0), last_(min) {}
+
+  uint64_t Next();
+  uint64_t Last() { return last_.load(std::memory_order_relaxed); }
+
+ private:
+  const uint64_t min_;
+  const uint64_t num_items_;
+  std::atomic<uint64_t> counter_;
+  std::atomic<uint64_t> last_;
+};
+
+inline uint64_t SequentialGenerator::Next() {
+  uint64_t value =
+      min_ + counter_.fetch_add(1, std::memory_order_relaxed) % num_items_;
+  last_.store(value, std::memory_order_relaxed);
+  return value;
+}
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_SEQUENTIAL_GENERATOR_H_
@@ -0,0 +1,68 @@
+//
+//  shifting_generator.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_SHIFTING_GENERATOR_H_
+#define YCSB_C_SHIFTING_GENERATOR_H_
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+#include "generator.h"
+#include "workload_clock.h"
+
+namespace ycsbc {
+
+///
+/// Moves the values of another generator through its range over time, so
+/// that its hot region shifts to other keys. Every interval (in seconds or
+/// operations of the clock) the values move up by shift, wrapping around.
+/// They rotate in steps at the end of each interval, or drift continuously.
+///
+class ShiftingGenerator : public Generator<uint64_t> {
+ public:
+  ///
+  /// Takes ownership of generator, whose values must be in [0, num_items).
+  ///
+  ShiftingGenerator(Generator<uint64_t> *generator, uint64_t num_items,
+                    uint64_t shift, double interval, bool drift,
+                    const WorkloadClock &clock, bool by_ops)
+      : generator_(generator),
+        num_items_(num_items),
+        shift_(shift % num_items),
+        interval_(interval),
+        drift_(drift),
+        clock_(clock),
+        by_ops_(by_ops),
+        last_(generator->Last()) {}
+
+  ~ShiftingGenerator() { delete generator_; }
+
+  uint64_t Next();
+  uint64_t Last() { return last_.load(std::memory_order_relaxed); }
+
+ private:
+  Generator<uint64_t> *generator_;
+  const uint64_t num_items_;
+  const uint64_t shift_;
+  const double interval_;
+  const bool drift_;
+  const WorkloadClock &clock_;
+  const bool by_ops_;
+  std::atomic<uint64_t> last_;
+};
+
+inline uint64_t ShiftingGenerator::Next() {
+  double intervals = clock_.Progress(by_ops_) / interval_;
+  if (!drift_) intervals = std::floor(intervals);
+  uint64_t offset = std::fmod(intervals * shift_, num_items_);
+  uint64_t value = (generator_->Next() + offset) % num_items_;
+  last_.store(value, std::memory_order_relaxed);
+  return value;
+}
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_SHIFTING_GENERATOR_H_
@@ -0,0 +1,43 @@
+//
+//  slice.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_SLICE_H_
+#define YCSB_C_SLICE_H_
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+namespace ycsbc {
+
+///
+/// A view of bytes owned elsewhere, which must outlive it.
+///
+class Slice {
+ public:
+  Slice() : data_(""), size_(0) {}
+  Slice(const char *data, size_t size) : data_(data), size_(size) {}
+  Slice(const std::string &s) : data_(s.data()), size_(s.size()) {}
+  Slice(const char *s) : data_(s), size_(strlen(s)) {}
+
+  const char *data() const { return data_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  std::string ToString() const { return std::string(data_, size_); }
+
+  bool operator==(const Slice &other) const {
+    return size_ == other.size_ && memcmp(data_, other.data_, size_) == 0;
+  }
+  bool operator!=(const Slice &other) const { return !(*this == other); }
+
+ private:
+  const char *data_;
+  size_t size_;
+};
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_SLICE_H_
@@ -0,0 +1,69 @@
+//
+//  status_reporter.cc
+//  YCSB-C
+//
+
+#include "status_reporter.h"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+
+using ycsbc::StatusReporter;
+
+void StatusReporter::Start(const std::string &phase) {
+  if (interval_sec_ <= 0 || thread_.joinable()) return;
+  phase_ = phase;
+  stop_ = false;
+  thread_ = std::thread(&StatusReporter::Run, this);
+}
+
+void StatusReporter::Stop() {
+  if (!thread_.joinable()) return;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+}
+
+void StatusReporter::Run() {
+  last_.Reset();
+  for (auto m : measurements_) {
+    last_.Merge(*m);
+  }
+  utils::Timer<double> timer;
+  timer.Start();
+  double last_sec = 0;
+  std::chrono::duration<double> interval(interval_sec_);
+  auto deadline = std::chrono::steady_clock::now();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stop_) {
+    deadline += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        interval);
+    if (cv_.wait_until(lock, deadline, [this] { return stop_; })) break;
+    double now_sec = timer.End();
+    Report(now_sec, now_sec - last_sec);
+    last_sec = now_sec;
+  }
+}
+
+void StatusReporter::Report(double elapsed_sec, double interval_sec) {
+  current_.Reset();
+  for (auto m : measurements_) {
+    current_.Merge(*m);
+  }
+  uint64_t total = current_.Count();
+  // current_ becomes the interval delta; keep the cumulative view in last_
+  current_.Subtract(last_);
+  uint64_t ops = current_.Count();
+
+  printf("[%s] %.0f sec: %" PRIu64 " operations; %.1f current ops/sec\n",
+         phase_.c_str(), elapsed_sec, total, ops / interval_sec);
+  printf("%s", current_.Summary().c_str());
+  fflush(stdout);
+
+  last_.Merge(current_);
+}
@@ -0,0 +1,55 @@
+//
+//  status_reporter.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_STATUS_REPORTER_H_
+#define YCSB_C_STATUS_REPORTER_H_
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "measurements.h"
+#include "timer.h"
+
+namespace ycsbc {
+
+///
+/// Background thread that periodically samples the per-thread measurements
+/// of the running phase and prints the throughput and latency percentiles of
+/// the last interval. Client threads are never blocked by the reporter.
+///
+class StatusReporter {
+ public:
+  StatusReporter(const std::vector<Measurements *> &measurements,
+                 double interval_sec)
+      : measurements_(measurements), interval_sec_(interval_sec) {}
+
+  ~StatusReporter() { Stop(); }
+
+  void Start(const std::string &phase);
+  void Stop();
+
+ private:
+  void Run();
+  void Report(double elapsed_sec, double interval_sec);
+
+  std::vector<Measurements *> measurements_;
+  double interval_sec_;
+  std::string phase_;
+
+  Measurements last_;
+  Measurements current_;
+
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stop_;
+};
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_STATUS_REPORTER_H_
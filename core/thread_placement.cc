@@ -0,0 +1,165 @@
+//
+//  thread_placement.cc
+//  YCSB-C
+//
+
+#include "thread_placement.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "utils.h"
+
+using std::string;
+using std::vector;
+using ycsbc::ThreadPlacement;
+
+namespace {
+
+const int kMpolBind = 2;  // MPOL_BIND of <numaif.h>, without needing libnuma
+
+vector<vector<int>> ReadNumaNodes() {
+  vector<vector<int>> nodes;
+  for (int node = 0;; ++node) {
+    std::ifstream input("/sys/devices/system/node/node" +
+                        std::to_string(node) + "/cpulist");
+    if (!input.is_open()) break;
+    string list;
+    std::getline(input, list);
+    nodes.push_back(ThreadPlacement::ParseCpuList(list));
+  }
+  if (nodes.empty()) {
+    // No NUMA information: a single node with all CPUs
+    nodes.emplace_back();
+    for (unsigned cpu = 0; cpu < std::thread::hardware_concurrency(); ++cpu) {
+      nodes.back().push_back(cpu);
+    }
+  }
+  return nodes;
+}
+
+vector<int> ReadOnlineCpus() {
+  std::ifstream input("/sys/devices/system/cpu/online");
+  string list;
+  if (input.is_open() && std::getline(input, list)) {
+    return ThreadPlacement::ParseCpuList(list);
+  }
+  vector<int> cpus;
+  for (unsigned cpu = 0; cpu < std::thread::hardware_concurrency(); ++cpu) {
+    cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+}  // namespace
+
+ThreadPlacement::ThreadPlacement(const string &affinity, bool local_memory)
+    : node_cpus_(ReadNumaNodes()), local_memory_(local_memory) {
+  if (affinity == "none" || affinity.empty()) {
+    return;
+  } else if (affinity == "numa") {
+    // Node-major interleaving: 1st CPU of each node, then the 2nd, ...
+    for (size_t i = 0;; ++i) {
+      bool any = false;
+      for (auto &cpus : node_cpus_) {
+        if (i < cpus.size()) {
+          cpus_.push_back(cpus[i]);
+          any = true;
+        }
+      }
+      if (!any) break;
+    }
+  } else {
+    cpus_ = ParseCpuList(affinity);
+    if (cpus_.empty()) {
+      throw utils::Exception("Invalid thread affinity: " + affinity);
+    }
+    vector<int> online = ReadOnlineCpus();
+    for (int cpu : cpus_) {
+      if (cpu >= CPU_SETSIZE ||
+          std::find(online.begin(), online.end(), cpu) == online.end()) {
+        throw utils::Exception("Thread affinity names CPU " +
+                               std::to_string(cpu) + ", which is not online");
+      }
+    }
+  }
+}
+
+int ThreadPlacement::Place(int index) const {
+  if (cpus_.empty()) return -1;
+  int cpu = cpus_[index % cpus_.size()];
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+    std::cerr << "Warning: cannot pin client thread " << index << " to CPU "
+              << cpu << std::endl;
+    return -1;
+  }
+
+  int node = NodeOf(cpu);
+  if (local_memory_ && node >= 0) {
+    unsigned long mask[16] = {0};
+    const unsigned long bits = 8 * sizeof(mask[0]);
+    mask[node / bits] |= 1UL << (node % bits);
+    if (syscall(SYS_set_mempolicy, kMpolBind, mask, 8 * sizeof(mask)) != 0) {
+      std::cerr << "Warning: cannot bind the memory of client thread "
+                << index << " to NUMA node " << node << std::endl;
+    }
+  }
+  return cpu;
+}
+
+vector<int> ThreadPlacement::ParseCpuList(const string &list) {
+  vector<int> cpus;
+  std::stringstream ranges(list);
+  string range;
+  while (std::getline(ranges, range, ',')) {
+    range = utils::Trim(range);
+    if (range.empty()) continue;
+    size_t dash = range.find('-');
+    int first, last;
+    try {
+      size_t end;
+      first = std::stoi(range.substr(0, dash), &end);
+      if (end != (dash == string::npos ? range.size() : dash)) {
+        throw std::invalid_argument(range);
+      }
+      last = first;
+      if (dash != string::npos) {
+        string tail = range.substr(dash + 1);
+        last = std::stoi(tail, &end);
+        if (end != tail.size()) throw std::invalid_argument(range);
+      }
+    } catch (const std::logic_error &) {
+      // invalid_argument and out_of_range from stoi
+      throw utils::Exception("Invalid CPU list: " + list);
+    }
+    if (first < 0 || last < first || last >= CPU_SETSIZE) {
+      throw utils::Exception("Invalid CPU range in list: " + list);
+    }
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+int ThreadPlacement::NodeOf(int cpu) const {
+  for (size_t node = 0; node < node_cpus_.size(); ++node) {
+    for (int c : node_cpus_[node]) {
+      if (c == cpu) return node;
+    }
+  }
+  return -1;
+}
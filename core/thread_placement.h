@@ -0,0 +1,54 @@
+//
+//  thread_placement.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_THREAD_PLACEMENT_H_
+#define YCSB_C_THREAD_PLACEMENT_H_
+
+#include <string>
+#include <vector>
+
+namespace ycsbc {
+
+///
+/// Decides which CPU each client thread runs on, and optionally binds the
+/// memory the thread allocates to the NUMA node of that CPU.
+///
+/// The affinity is "none" (threads float), "numa" (threads are spread round
+/// robin over the NUMA nodes, one CPU each), or an explicit CPU list such as
+/// "0-7,16-23" (thread i runs on the i-th CPU of the list, wrapping around).
+///
+class ThreadPlacement {
+ public:
+  ///
+  /// Throws utils::Exception if the affinity is malformed or names a CPU
+  /// that is not online, so that it is caught before any thread starts.
+  ///
+  ThreadPlacement(const std::string &affinity, bool local_memory);
+
+  ///
+  /// Applies the placement of client thread index to the calling thread.
+  /// Runs on client threads, so failures are reported as warnings and the
+  /// thread carries on unplaced.
+  /// @return The CPU the thread is pinned to, or -1 if it is not pinned.
+  ///
+  int Place(int index) const;
+
+  ///
+  /// Parses a CPU list like "0-3,8,10-11".
+  /// Throws utils::Exception if it is malformed.
+  ///
+  static std::vector<int> ParseCpuList(const std::string &list);
+
+ private:
+  int NodeOf(int cpu) const;
+
+  std::vector<std::vector<int>> node_cpus_;  /// CPUs of each NUMA node
+  std::vector<int> cpus_;  /// CPUs in the order threads are pinned to
+  bool local_memory_;
+};
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_THREAD_PLACEMENT_H_
@@ -10,9 +10,19 @@
 #define YCSB_C_TIMER_H_
 
 #include <chrono>
+#include <cstdint>
 
 namespace utils {
 
+///
+/// Monotonic timestamp in nanoseconds, used for per-operation latencies.
+///
+inline uint64_t NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
 template <typename T>
 class Timer {
  public:
@@ -0,0 +1,263 @@
+//
+//  trace_workload.cc
+//  YCSB-C
+//
+
+#include "trace_workload.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <sstream>
+
+#include "utils.h"
+
+using std::string;
+using std::vector;
+using ycsbc::TraceRecord;
+using ycsbc::TraceWorkload;
+
+const string TraceWorkload::TRACE_FILE_PROPERTY = "tracefile";
+
+const string TraceWorkload::TRACE_FORMAT_PROPERTY = "traceformat";
+const string TraceWorkload::TRACE_FORMAT_DEFAULT = "csv";
+
+const string TraceWorkload::TRACE_TIME_UNIT_PROPERTY = "tracetimeunit";
+const string TraceWorkload::TRACE_TIME_UNIT_DEFAULT = "us";
+
+const string TraceWorkload::TRACE_PACING_PROPERTY = "tracepacing";
+const string TraceWorkload::TRACE_PACING_DEFAULT = "fast";
+
+const string TraceWorkload::TRACE_SPEEDUP_PROPERTY = "tracespeedup";
+const string TraceWorkload::TRACE_SPEEDUP_DEFAULT = "1";
+
+const string TraceWorkload::TRACE_BUFFER_PROPERTY = "tracebuffer";
+const string TraceWorkload::TRACE_BUFFER_DEFAULT = "65536";
+
+namespace {
+
+const char kBinaryMagic[8] = {'Y', 'C', 'S', 'B', 'T', 'R', 'C', '1'};
+
+struct BinaryRecord {
+  uint64_t timestamp;
+  uint32_t value_size;
+  uint16_t key_length;
+  uint8_t op;
+  uint8_t reserved;
+};
+
+static_assert(sizeof(BinaryRecord) == 16, "BinaryRecord must be packed");
+
+bool ParseOperation(string name, ycsbc::Operation *op) {
+  std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+  if (name == "GET") {
+    *op = ycsbc::READ;
+    return true;
+  } else if (name == "PUT" || name == "SET") {
+    *op = ycsbc::UPDATE;
+    return true;
+  }
+  // Traces hold operations on single keys only
+  for (int i = 0; i <= ycsbc::DELETE; ++i) {
+    ycsbc::Operation candidate = static_cast<ycsbc::Operation>(i);
+    if (name == ycsbc::OperationName(candidate)) {
+      *op = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+TraceWorkload::TraceWorkload()
+    : binary_(NULL),
+      timestamp_pacing_(false),
+      nanos_per_tick_(1),
+      head_(0),
+      count_(0),
+      first_pushed_(false),
+      first_timestamp_(0),
+      done_(false),
+      stop_(false) {}
+
+TraceWorkload::~TraceWorkload() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  not_full_.notify_all();
+  if (reader_.joinable()) reader_.join();
+  if (binary_) fclose(binary_);
+}
+
+void TraceWorkload::Init(const utils::Properties &p) {
+  path_ = p.GetProperty(TRACE_FILE_PROPERTY);
+
+  string unit =
+      p.GetProperty(TRACE_TIME_UNIT_PROPERTY, TRACE_TIME_UNIT_DEFAULT);
+  if (unit == "ns") {
+    nanos_per_tick_ = 1;
+  } else if (unit == "us") {
+    nanos_per_tick_ = 1e3;
+  } else if (unit == "ms") {
+    nanos_per_tick_ = 1e6;
+  } else if (unit == "s") {
+    nanos_per_tick_ = 1e9;
+  } else {
+    throw utils::Exception("Unknown trace time unit: " + unit);
+  }
+  double speedup =
+      std::stod(p.GetProperty(TRACE_SPEEDUP_PROPERTY, TRACE_SPEEDUP_DEFAULT));
+  if (speedup <= 0) {
+    throw utils::Exception("Trace speedup must be positive");
+  }
+  nanos_per_tick_ /= speedup;
+
+  string pacing = p.GetProperty(TRACE_PACING_PROPERTY, TRACE_PACING_DEFAULT);
+  if (pacing == "timestamp") {
+    timestamp_pacing_ = true;
+  } else if (pacing != "fast") {
+    throw utils::Exception("Unknown trace pacing: " + pacing);
+  }
+
+  size_t buffer =
+      std::stoul(p.GetProperty(TRACE_BUFFER_PROPERTY, TRACE_BUFFER_DEFAULT));
+  ring_.resize(std::max<size_t>(buffer, kReadBatch));
+
+  string format = p.GetProperty(TRACE_FORMAT_PROPERTY, TRACE_FORMAT_DEFAULT);
+  if (format == "csv") {
+    csv_.open(path_);
+    if (!csv_.is_open()) {
+      throw utils::Exception(path_ + ": cannot open trace");
+    }
+    reader_ = std::thread(&TraceWorkload::ReadCsv, this);
+  } else if (format == "binary") {
+    binary_ = fopen(path_.c_str(), "rb");
+    if (!binary_) {
+      throw utils::Exception(path_ + ": cannot open trace");
+    }
+    setvbuf(binary_, NULL, _IOFBF, 1 << 20);
+    char magic[sizeof(kBinaryMagic)];
+    if (fread(magic, sizeof(magic), 1, binary_) != 1 ||
+        memcmp(magic, kBinaryMagic, sizeof(magic)) != 0) {
+      throw utils::Exception(path_ + ": not a binary trace");
+    }
+    reader_ = std::thread(&TraceWorkload::ReadBinary, this);
+  } else {
+    throw utils::Exception("Unknown trace format: " + format);
+  }
+}
+
+size_t TraceWorkload::NextBatch(vector<TraceRecord> *batch, size_t max) {
+  if (batch->size() < max) batch->resize(max);
+  std::unique_lock<std::mutex> lock(mutex_);
+  not_empty_.wait(lock, [this] { return count_ > 0 || done_; });
+  size_t taken = std::min(count_, max);
+  for (size_t i = 0; i < taken; ++i) {
+    std::swap((*batch)[i], ring_[head_]);
+    head_ = (head_ + 1) % ring_.size();
+  }
+  // Wake the reader only once a whole batch fits again
+  const size_t refill = ring_.size() - kReadBatch;
+  bool was_full = count_ > refill;
+  count_ -= taken;
+  if (was_full && count_ <= refill) not_full_.notify_one();
+  return taken;
+}
+
+uint64_t TraceWorkload::OffsetNanos(const TraceRecord &record) const {
+  // Set before the first record was handed out
+  if (record.timestamp <= first_timestamp_) return 0;
+  return (record.timestamp - first_timestamp_) * nanos_per_tick_;
+}
+
+string TraceWorkload::error() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return error_;
+}
+
+bool TraceWorkload::Push(vector<TraceRecord> &batch) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  not_full_.wait(lock, [&] {
+    return stop_ || count_ + batch.size() <= ring_.size();
+  });
+  if (stop_) return false;
+  if (!first_pushed_ && !batch.empty()) {
+    first_timestamp_ = batch.front().timestamp;
+    first_pushed_ = true;
+  }
+  for (TraceRecord &record : batch) {
+    std::swap(ring_[(head_ + count_) % ring_.size()], record);
+    ++count_;
+  }
+  lock.unlock();
+  not_empty_.notify_all();
+  batch.clear();
+  return true;
+}
+
+void TraceWorkload::Finish(const string &error) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    done_ = true;
+    error_ = error;
+  }
+  not_empty_.notify_all();
+}
+
+void TraceWorkload::ReadCsv() {
+  vector<TraceRecord> batch;
+  string line, field;
+  for (uint64_t line_num = 1; std::getline(csv_, line); ++line_num) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (line.empty() || line[0] == '#') continue;
+
+    std::istringstream fields(line);
+    vector<string> columns;
+    while (std::getline(fields, field, ',')) {
+      columns.push_back(utils::Trim(field));
+    }
+    TraceRecord record;
+    bool valid = columns.size() == 4 && ParseOperation(columns[1], &record.op);
+    if (valid) {
+      try {
+        record.timestamp = std::stoull(columns[0]);
+        record.value_size = std::stoul(columns[3]);
+      } catch (const std::exception &) {
+        valid = false;
+      }
+    }
+    if (!valid) {
+      if (Push(batch)) {
+        Finish(path_ + ":" + std::to_string(line_num) + ": malformed record");
+      }
+      return;
+    }
+    record.key.swap(columns[2]);
+    batch.push_back(std::move(record));
+    if (batch.size() == kReadBatch && !Push(batch)) return;
+  }
+  if (Push(batch)) Finish("");
+}
+
+void TraceWorkload::ReadBinary() {
+  vector<TraceRecord> batch;
+  BinaryRecord header;
+  while (fread(&header, sizeof(header), 1, binary_) == 1) {
+    TraceRecord record;
+    record.timestamp = header.timestamp;
+    record.value_size = header.value_size;
+    record.key.resize(header.key_length);
+    if (header.op > DELETE ||
+        (header.key_length &&
+         fread(&record.key[0], header.key_length, 1, binary_) != 1)) {
+      if (Push(batch)) Finish(path_ + ": malformed record");
+      return;
+    }
+    record.op = static_cast<Operation>(header.op);
+    batch.push_back(std::move(record));
+    if (batch.size() == kReadBatch && !Push(batch)) return;
+  }
+  if (Push(batch)) Finish("");
+}
@@ -0,0 +1,150 @@
+//
+//  trace_workload.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_TRACE_WORKLOAD_H_
+#define YCSB_C_TRACE_WORKLOAD_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core_workload.h"
+#include "properties.h"
+
+namespace ycsbc {
+
+///
+/// One operation of a recorded trace.
+///
+struct TraceRecord {
+  TraceRecord() : timestamp(0), op(READ), value_size(0) {}
+
+  uint64_t timestamp;  /// In the time unit of the trace
+  Operation op;
+  std::string key;
+  uint32_t value_size;  /// Scan length for scans
+};
+
+///
+/// Workload replaying a recorded trace of (timestamp, op, key, value size)
+/// instead of drawing operations from distributions.
+///
+/// The trace is read by a background thread into a bounded ring buffer, from
+/// which the client threads take the operations in trace order, so traces of
+/// any size are streamed from disk rather than held in memory.
+///
+/// Traces are CSV, one "timestamp,op,key,value size" per line (lines starting
+/// with '#' are skipped), or binary: the magic "YCSBTRC1" followed by records
+/// of a 64-bit timestamp, a 32-bit value size, a 16-bit key length, the 8-bit
+/// op, a reserved byte and the key, in native byte order. Ops are named as in
+/// the measurements, case-insensitive; GET, PUT and SET are accepted too.
+///
+class TraceWorkload {
+ public:
+  ///
+  /// The path of the trace to replay.
+  ///
+  static const std::string TRACE_FILE_PROPERTY;
+
+  ///
+  /// The format of the trace: csv or binary.
+  ///
+  static const std::string TRACE_FORMAT_PROPERTY;
+  static const std::string TRACE_FORMAT_DEFAULT;
+
+  ///
+  /// The unit of the timestamps: ns, us, ms or s.
+  ///
+  static const std::string TRACE_TIME_UNIT_PROPERTY;
+  static const std::string TRACE_TIME_UNIT_DEFAULT;
+
+  ///
+  /// How operations are issued: fast (as fast as possible) or timestamp (at
+  /// the times of the trace relative to its first operation).
+  ///
+  static const std::string TRACE_PACING_PROPERTY;
+  static const std::string TRACE_PACING_DEFAULT;
+
+  ///
+  /// Factor by which timestamp pacing compresses the time of the trace.
+  ///
+  static const std::string TRACE_SPEEDUP_PROPERTY;
+  static const std::string TRACE_SPEEDUP_DEFAULT;
+
+  ///
+  /// The number of operations buffered ahead of the client threads.
+  ///
+  static const std::string TRACE_BUFFER_PROPERTY;
+  static const std::string TRACE_BUFFER_DEFAULT;
+
+  TraceWorkload();
+  ~TraceWorkload();
+
+  ///
+  /// Opens the trace and starts reading it.
+  ///
+  void Init(const utils::Properties &p);
+
+  ///
+  /// Takes up to max operations of the trace under a single lock, blocking
+  /// while the reader is behind and none are buffered. Thread-safe. The records are swapped into the front of
+  /// batch, which is grown to max, so that their strings are reused.
+  /// @return The number taken, 0 when the trace is exhausted.
+  ///
+  size_t NextBatch(std::vector<TraceRecord> *batch, size_t max);
+
+  bool timestamp_pacing() const { return timestamp_pacing_; }
+
+  ///
+  /// Returns when a taken operation is due, in nanoseconds after the start
+  /// of the replay.
+  ///
+  uint64_t OffsetNanos(const TraceRecord &record) const;
+
+  ///
+  /// Returns why reading stopped before the end of the trace, if it did.
+  ///
+  std::string error();
+
+ private:
+  static const size_t kReadBatch = 256;
+
+  void ReadCsv();
+  void ReadBinary();
+  ///
+  /// Moves a batch of parsed records into the buffer.
+  /// @return false if the workload is being destroyed.
+  ///
+  bool Push(std::vector<TraceRecord> &batch);
+  void Finish(const std::string &error);
+
+  std::string path_;
+  std::ifstream csv_;
+  FILE *binary_;
+  bool timestamp_pacing_;
+  double nanos_per_tick_;  /// Timestamp unit over the speedup
+
+  std::vector<TraceRecord> ring_;
+  size_t head_;   /// Slot of the next record to take
+  size_t count_;  /// Number of buffered records
+  bool first_pushed_;
+  uint64_t first_timestamp_;
+  bool done_;  /// No more records will be pushed
+  bool stop_;  /// Reader asked to quit
+  std::string error_;
+  std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+  std::thread reader_;
+};
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_TRACE_WORKLOAD_H_
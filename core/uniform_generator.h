@@ -10,36 +10,33 @@
 #define YCSB_C_UNIFORM_GENERATOR_H_
 
 #include <atomic>
-#include <mutex>
-#include <random>
 
 #include "generator.h"
+#include "utils.h"
 
 namespace ycsbc {
 
 class UniformGenerator : public Generator<uint64_t> {
  public:
   // Both min and max are inclusive
-  UniformGenerator(uint64_t min, uint64_t max) : dist_(min, max) { Next(); }
+  UniformGenerator(uint64_t min, uint64_t max)
+      : min_(min), num_items_(max - min + 1) {
+    Next();
+  }
 
   uint64_t Next();
-  uint64_t Last();
+  uint64_t Last() { return last_int_.load(std::memory_order_relaxed); }
 
  private:
-  std::mt19937_64 generator_;
-  std::uniform_int_distribution<uint64_t> dist_;
-  uint64_t last_int_;
-  std::mutex mutex_;
+  const uint64_t min_;
+  const uint64_t num_items_;  /// 0 if the range covers all 64-bit values
+  std::atomic<uint64_t> last_int_;
 };
 
 inline uint64_t UniformGenerator::Next() {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return last_int_ = dist_(generator_);
-}
-
-inline uint64_t UniformGenerator::Last() {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return last_int_;
+  uint64_t value = min_ + utils::ThreadRandom().Uniform(num_items_);
+  last_int_.store(value, std::memory_order_relaxed);
+  return value;
 }
 
 }  // namespace ycsbc
@@ -10,9 +10,10 @@
 #define YCSB_C_UTILS_H_
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <exception>
-#include <random>
+#include <string>
 
 namespace utils {
 
@@ -34,16 +35,81 @@ inline uint64_t FNVHash64(uint64_t val) {
 
 inline uint64_t Hash(uint64_t val) { return FNVHash64(val); }
 
+inline uint64_t SplitMix64(uint64_t &state) {
+  uint64_t z = (state += 0x9E3779B97F4A7C15);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+  return z ^ (z >> 31);
+}
+
+///
+/// xoshiro256** pseudo-random generator. Not thread-safe: every thread uses
+/// its own instance through ThreadRandom().
+///
+class Random {
+ public:
+  explicit Random(uint64_t seed) { Seed(seed); }
+
+  void Seed(uint64_t seed) {
+    for (int i = 0; i < 4; ++i) {
+      s_[i] = SplitMix64(seed);
+    }
+  }
+
+  uint64_t Next() {
+    const uint64_t result = Rotl(s_[1] * 5, 7) * 9;
+    const uint64_t t = s_[1] << 17;
+    s_[2] ^= s_[0];
+    s_[3] ^= s_[1];
+    s_[1] ^= s_[2];
+    s_[0] ^= s_[3];
+    s_[2] ^= t;
+    s_[3] = Rotl(s_[3], 45);
+    return result;
+  }
+
+  ///
+  /// Uniform in [0, n), or over all 64-bit values if n is 0.
+  ///
+  uint64_t Uniform(uint64_t n) {
+    if (n == 0) return Next();
+    return static_cast<uint64_t>((static_cast<unsigned __int128>(Next()) * n) >>
+                                 64);
+  }
+
+  ///
+  /// Uniform in [0, 1).
+  ///
+  double NextDouble() { return (Next() >> 11) * (1.0 / (1ULL << 53)); }
+
+ private:
+  static uint64_t Rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+  uint64_t s_[4];
+};
+
+///
+/// Seed for the random generator of the next thread that needs one. Threads
+/// that must be reproducible re-seed ThreadRandom() explicitly.
+///
+inline uint64_t NextThreadSeed() {
+  static std::atomic<uint64_t> threads(0);
+  return threads.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline Random &ThreadRandom() {
+  static thread_local Random random(NextThreadSeed());
+  return random;
+}
+
 inline double RandomDouble(double min = 0.0, double max = 1.0) {
-  static std::default_random_engine generator;
-  static std::uniform_real_distribution<double> uniform(min, max);
-  return uniform(generator);
+  return min + (max - min) * ThreadRandom().NextDouble();
 }
 
 ///
 /// Returns an ASCII code that can be printed to desplay
 ///
-inline char RandomPrintChar() { return rand() % 94 + 33; }
+inline char RandomPrintChar() { return ThreadRandom().Uniform(94) + 33; }
 
 class Exception : public std::exception {
  public:
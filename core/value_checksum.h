@@ -0,0 +1,59 @@
+//
+//  value_checksum.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_VALUE_CHECKSUM_H_
+#define YCSB_C_VALUE_CHECKSUM_H_
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "crc32c.h"
+#include "slice.h"
+
+namespace ycsbc {
+
+///
+/// Values written in verify mode start with a header of three 32-bit words
+/// in native byte order: the CRC32C of the rest of the value, the version of
+/// the record the value was written in, and a seed derived from the key and
+/// the field, so that a value returned for the wrong key or field is caught
+/// too. Shorter values are lengthened to the header.
+///
+const size_t kValueHeaderLength = 12;
+
+inline uint32_t ValueSeed(const Slice &key, const Slice &field) {
+  return crc32c::Extend(crc32c::Value(key.data(), key.size()), field.data(),
+                        field.size());
+}
+
+inline void StampValue(uint32_t seed, uint32_t version, std::string *value) {
+  if (value->size() < kValueHeaderLength) value->resize(kValueHeaderLength);
+  char *header = &(*value)[0];
+  memcpy(header + 4, &version, sizeof(version));
+  memcpy(header + 8, &seed, sizeof(seed));
+  uint32_t crc = crc32c::Value(header + 4, value->size() - 4);
+  memcpy(header, &crc, sizeof(crc));
+}
+
+///
+/// Checks a value read and returns its version in version.
+/// @param seed The seed of the key and field, or NULL if the key is unknown.
+/// @return false if the value is corrupted.
+///
+inline bool CheckValue(const uint32_t *seed, const Slice &value,
+                       uint32_t *version) {
+  if (value.size() < kValueHeaderLength) return false;
+  uint32_t crc, value_seed;
+  memcpy(&crc, value.data(), sizeof(crc));
+  memcpy(version, value.data() + 4, sizeof(*version));
+  memcpy(&value_seed, value.data() + 8, sizeof(value_seed));
+  if (seed && value_seed != *seed) return false;
+  return crc == crc32c::Value(value.data() + 4, value.size() - 4);
+}
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_VALUE_CHECKSUM_H_
@@ -0,0 +1,68 @@
+//
+//  value_pool.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_VALUE_POOL_H_
+#define YCSB_C_VALUE_POOL_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+#include "utils.h"
+
+namespace ycsbc {
+
+///
+/// A buffer of pre-generated random printable data that values are sliced
+/// from, in the style of db_bench's RandomGenerator.
+///
+/// The data is made of 100-byte pieces, each of which repeats a random
+/// prefix of compression_ratio * 100 bytes, so values compress to about
+/// compression_ratio of their size. The pool is immutable once built and
+/// shared by all threads.
+///
+class ValuePool {
+ public:
+  static const size_t kPieceLength = 100;
+
+  ValuePool(size_t size, double compression_ratio, uint64_t seed = 0);
+
+  ///
+  /// Returns len bytes of the pool, at most size(), starting at a random
+  /// offset.
+  ///
+  const char *Next(size_t len) const;
+
+  size_t size() const { return data_.size(); }
+
+ private:
+  std::string data_;
+};
+
+inline ValuePool::ValuePool(size_t size, double compression_ratio,
+                            uint64_t seed) {
+  utils::Random random(seed);
+  compression_ratio = std::min(std::max(compression_ratio, 0.0), 1.0);
+  size_t raw = std::max<size_t>(1, compression_ratio * kPieceLength + 0.5);
+  data_.reserve(size + kPieceLength);
+  while (data_.size() < size) {
+    size_t start = data_.size();
+    for (size_t i = 0; i < raw; ++i) {
+      data_.push_back(' ' + random.Uniform(95));
+    }
+    while (data_.size() < start + kPieceLength) {
+      data_.push_back(data_[start + (data_.size() - start) % raw]);
+    }
+  }
+}
+
+inline const char *ValuePool::Next(size_t len) const {
+  if (len >= data_.size()) return data_.data();
+  return data_.data() + utils::ThreadRandom().Uniform(data_.size() - len + 1);
+}
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_VALUE_POOL_H_
@@ -0,0 +1,199 @@
+//
+//  version_table.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_VERSION_TABLE_H_
+#define YCSB_C_VERSION_TABLE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace ycsbc {
+
+///
+/// The versions verify mode tracks for the records of a table: per record,
+/// the last version handed out to a write, the number of writes in flight,
+/// and the oldest version a read may still return.
+///
+/// All three fit in one 64-bit word per record. Versions are tags from 1 to
+/// kMaxVersion that wrap around, 0 meaning none, and a version counts as
+/// older than another only if it is less than half the cycle behind it, so
+/// stale reads are caught as long as they are that recent. While writes keep
+/// overlapping, the expected version cannot move, so it is dropped once it
+/// falls a quarter of the cycle behind rather than wrap around. The words are
+/// allocated a segment at a time by the first write into it, so that the
+/// table costs nothing up front and is filled in by the client threads.
+///
+class VersionTable {
+ public:
+  static const uint32_t kMaxVersion = (1 << 24) - 1;
+
+  VersionTable()
+      : segments_(new std::atomic<std::atomic<uint64_t> *>[kMaxSegments]) {
+    for (uint64_t i = 0; i < kMaxSegments; ++i) {
+      segments_[i].store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  ~VersionTable() {
+    for (uint64_t i = 0; i < kMaxSegments; ++i) {
+      delete[] segments_[i].load(std::memory_order_relaxed);
+    }
+  }
+
+  VersionTable(const VersionTable &) = delete;
+  VersionTable &operator=(const VersionTable &) = delete;
+
+  ///
+  /// Hands out a new version of the record for a write. Thread-safe.
+  /// @return A ticket for Acknowledge(), whose low 32 bits are the version,
+  ///         or 0 if the record cannot be tracked.
+  ///
+  uint64_t Stamp(uint64_t key_num);
+  ///
+  /// Marks a stamped write as done. If it succeeded and no other write of
+  /// the record was in flight when it was stamped, reads started afterwards
+  /// must not return an older version. Thread-safe.
+  ///
+  void Acknowledge(uint64_t key_num, uint64_t ticket, bool succeeded);
+  ///
+  /// Returns the oldest version of the record a read may return, or 0.
+  ///
+  uint32_t Expected(uint64_t key_num) const;
+
+  ///
+  /// Whether version is older than expected, within half the cycle.
+  ///
+  static bool IsOlder(uint32_t version, uint32_t expected) {
+    if (version == 0 || expected == 0) return false;
+    uint32_t behind = (expected + kMaxVersion - version) % kMaxVersion;
+    return behind != 0 && behind <= kMaxVersion / 2;
+  }
+
+ private:
+  // Fields of a word
+  static const uint64_t kInFlightMask = (1ULL << 16) - 1;
+  static const int kHandedOutShift = 16;
+  static const int kExpectedShift = 40;
+  static const uint64_t kVersionMask = (1ULL << 24) - 1;
+
+  static const int kSegmentBits = 20;
+  static const uint64_t kSegmentSize = 1ULL << kSegmentBits;
+  static const uint64_t kMaxSegments = 1 << 16;  /// Records up to 2^36
+
+  static uint32_t HandedOut(uint64_t word) {
+    return (word >> kHandedOutShift) & kVersionMask;
+  }
+  static uint32_t ExpectedOf(uint64_t word) {
+    return (word >> kExpectedShift) & kVersionMask;
+  }
+
+  ///
+  /// Returns the segment of the record, allocating it if create is set, or
+  /// NULL if there is none.
+  ///
+  std::atomic<uint64_t> *Segment(uint64_t key_num, bool create) const;
+
+  std::unique_ptr<std::atomic<std::atomic<uint64_t> *>[]> segments_;
+};
+
+inline std::atomic<uint64_t> *VersionTable::Segment(uint64_t key_num,
+                                                     bool create) const {
+  std::atomic<std::atomic<uint64_t> *> &slot =
+      segments_[key_num >> kSegmentBits];
+  std::atomic<uint64_t> *segment = slot.load(std::memory_order_acquire);
+  if (segment || !create) return segment;
+  std::unique_ptr<std::atomic<uint64_t>[]> created(
+      new std::atomic<uint64_t>[kSegmentSize]);
+  for (uint64_t i = 0; i < kSegmentSize; ++i) {
+    created[i].store(0, std::memory_order_relaxed);
+  }
+  // Another thread may have got there first
+  if (slot.compare_exchange_strong(segment, created.get(),
+                                   std::memory_order_acq_rel)) {
+    segment = created.release();
+  }
+  return segment;
+}
+
+inline uint64_t VersionTable::Stamp(uint64_t key_num) {
+  if (key_num >= kMaxSegments * kSegmentSize) return 0;
+  std::atomic<uint64_t> &word =
+      Segment(key_num, true)[key_num & (kSegmentSize - 1)];
+  uint64_t old = word.load(std::memory_order_relaxed);
+  uint32_t version;
+  uint64_t updated;
+  do {
+    if ((old & kInFlightMask) == kInFlightMask) return 0;
+    version = HandedOut(old) % kMaxVersion + 1;
+    updated = (old & ~(kVersionMask << kHandedOutShift)) +
+              (uint64_t{version} << kHandedOutShift) + 1;
+    uint32_t expected = ExpectedOf(old);
+    if (expected != 0 &&
+        (version + kMaxVersion - expected) % kMaxVersion > kMaxVersion / 4) {
+      updated &= ~(kVersionMask << kExpectedShift);
+    }
+  } while (!word.compare_exchange_weak(old, updated,
+                                       std::memory_order_relaxed));
+  // Whether the write is ordered after all others
+  uint64_t ordered = (old & kInFlightMask) == 0;
+  return version | ordered << 32;
+}
+
+inline void VersionTable::Acknowledge(uint64_t key_num, uint64_t ticket,
+                                      bool succeeded) {
+  if (ticket == 0) return;
+  std::atomic<uint64_t> &word =
+      Segment(key_num, false)[key_num & (kSegmentSize - 1)];
+  // Overlapping writes may land in any order, so only ordered ones count
+  const uint32_t version = static_cast<uint32_t>(ticket);
+  const bool raise = succeeded && (ticket >> 32);
+  uint64_t old = word.load(std::memory_order_relaxed);
+  uint64_t updated;
+  do {
+    updated = old - 1;
+    uint32_t expected = ExpectedOf(old);
+    if (raise && (expected == 0 || IsOlder(expected, version))) {
+      updated = (updated & ~(kVersionMask << kExpectedShift)) |
+                uint64_t{version} << kExpectedShift;
+    }
+  } while (!word.compare_exchange_weak(old, updated, std::memory_order_release,
+                                       std::memory_order_relaxed));
+}
+
+inline uint32_t VersionTable::Expected(uint64_t key_num) const {
+  if (key_num >= kMaxSegments * kSegmentSize) return 0;
+  std::atomic<uint64_t> *segment = Segment(key_num, false);
+  if (!segment) return 0;
+  return ExpectedOf(
+      segment[key_num & (kSegmentSize - 1)].load(std::memory_order_acquire));
+}
+
+///
+/// The version tables of all tables by name, kept for as long as the DB is
+/// open so that each phase checks reads against the writes of the phases
+/// before it, not only its own.
+///
+class VersionTables {
+ public:
+  ///
+  /// Returns the table of the given name, creating it on first use. Not
+  /// thread-safe; called while initializing workloads.
+  ///
+  VersionTable *Get(const std::string &table) {
+    std::unique_ptr<VersionTable> &versions = tables_[table];
+    if (!versions) versions.reset(new VersionTable);
+    return versions.get();
+  }
+
+ private:
+  std::map<std::string, std::unique_ptr<VersionTable>> tables_;
+};
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_VERSION_TABLE_H_
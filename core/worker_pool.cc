@@ -0,0 +1,105 @@
+//
+//  worker_pool.cc
+//  YCSB-C
+//
+
+#include "worker_pool.h"
+
+#include <algorithm>
+
+#include "timer.h"
+
+using ycsbc::WorkerPool;
+
+WorkerPool::WorkerPool(int num_workers, const Task &init)
+    : num_workers_(num_workers),
+      init_(init),
+      generation_(0),
+      initialized_(0),
+      ready_(0),
+      done_(0),
+      shutdown_(false),
+      released_(0),
+      release_ns_(0),
+      start_ns_(num_workers, 0),
+      end_ns_(num_workers, 0) {
+  for (int i = 0; i < num_workers; ++i) {
+    threads_.emplace_back(&WorkerPool::Work, this, i);
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  state_cv_.wait(lock, [this] { return initialized_ == size(); });
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  task_cv_.notify_all();
+  for (auto &t : threads_) {
+    t.join();
+  }
+}
+
+void WorkerPool::Prepare(const Task &task) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  task_ = task;
+  ready_ = 0;
+  done_ = 0;
+  ++generation_;
+  task_cv_.notify_all();
+  state_cv_.wait(lock, [this] { return ready_ == size(); });
+}
+
+void WorkerPool::Release() {
+  release_ns_ = utils::NowNanos();
+  released_.store(generation_, std::memory_order_release);
+}
+
+void WorkerPool::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  state_cv_.wait(lock, [this] { return done_ == size(); });
+}
+
+uint64_t WorkerPool::LastEndNanos() const {
+  return *std::max_element(end_ns_.begin(), end_ns_.end());
+}
+
+uint64_t WorkerPool::StartSkewNanos() const {
+  return *std::max_element(start_ns_.begin(), start_ns_.end()) -
+         *std::min_element(start_ns_.begin(), start_ns_.end());
+}
+
+uint64_t WorkerPool::EndSkewNanos() const {
+  return LastEndNanos() - *std::min_element(end_ns_.begin(), end_ns_.end());
+}
+
+void WorkerPool::Work(int index) {
+  if (init_) init_(index);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (++initialized_ == size()) state_cv_.notify_all();
+  }
+  uint64_t seen = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      task_cv_.wait(lock,
+                    [this, seen] { return shutdown_ || generation_ != seen; });
+      if (shutdown_) return;
+      seen = generation_;
+      if (++ready_ == size()) state_cv_.notify_all();
+    }
+    // Spin rather than block, so that all workers leave the barrier at once
+    while (released_.load(std::memory_order_acquire) != seen) {
+      std::this_thread::yield();
+    }
+    start_ns_[index] = utils::NowNanos();
+    task_(index);
+    end_ns_[index] = utils::NowNanos();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (++done_ == size()) state_cv_.notify_all();
+    }
+  }
+}
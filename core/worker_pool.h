@@ -0,0 +1,80 @@
+//
+//  worker_pool.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_WORKER_POOL_H_
+#define YCSB_C_WORKER_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ycsbc {
+
+///
+/// Client threads that live for the whole benchmark and run one task per
+/// phase. A phase is handed out in three steps, so that thread start-up stays
+/// out of the measured window and all workers begin at the same moment:
+/// Prepare() parks every worker at a barrier, Release() lets them all go, and
+/// Wait() returns once the last one has finished.
+///
+class WorkerPool {
+ public:
+  typedef std::function<void(int)> Task;  /// Called with the worker index
+
+  ///
+  /// Starts the workers and returns once init has run on each of them.
+  ///
+  WorkerPool(int num_workers, const Task &init);
+  ~WorkerPool();
+
+  int size() const { return num_workers_; }
+
+  void Prepare(const Task &task);
+  void Release();
+  void Wait();
+
+  uint64_t release_ns() const { return release_ns_; }
+  uint64_t start_ns(int worker) const { return start_ns_[worker]; }
+  uint64_t end_ns(int worker) const { return end_ns_[worker]; }
+  ///
+  /// Time of the last worker to finish the phase.
+  ///
+  uint64_t LastEndNanos() const;
+  ///
+  /// Spread between the first and the last worker to start (end) the phase.
+  ///
+  uint64_t StartSkewNanos() const;
+  uint64_t EndSkewNanos() const;
+
+ private:
+  void Work(int index);
+
+  const int num_workers_;
+  Task init_;
+  Task task_;
+  std::vector<std::thread> threads_;
+
+  std::mutex mutex_;
+  std::condition_variable task_cv_;   /// Workers wait here for a new task
+  std::condition_variable state_cv_;  /// The main thread waits here
+  uint64_t generation_;               /// Number of tasks handed out
+  int initialized_;                   /// Workers that have run init
+  int ready_;                         /// Workers at the barrier
+  int done_;                          /// Workers that finished the task
+  bool shutdown_;
+
+  std::atomic<uint64_t> released_;  /// Last generation released
+  uint64_t release_ns_;
+  std::vector<uint64_t> start_ns_;
+  std::vector<uint64_t> end_ns_;
+};
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_WORKER_POOL_H_
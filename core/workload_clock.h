@@ -0,0 +1,87 @@
+//
+//  workload_clock.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_WORKLOAD_CLOCK_H_
+#define YCSB_C_WORKLOAD_CLOCK_H_
+
+#include <atomic>
+#include <cstdint>
+
+#include "timer.h"
+
+namespace ycsbc {
+
+///
+/// How far a workload has progressed, in seconds since it started or in
+/// operations drawn, for workloads that change over time.
+///
+/// Operations are counted per thread and added to the shared count a chunk
+/// at a time, so that counting does not bounce one cache line between all
+/// client threads. Ops() therefore lags by less than kOpsPerChunk per thread.
+///
+class WorkloadClock {
+ public:
+  static const uint64_t kOpsPerChunk = 64;
+
+  WorkloadClock() : start_ns_(0), ops_(0) {
+    for (Slot &slot : slots_) {
+      slot.ops.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  ///
+  /// Starts the clock and the operation count over.
+  ///
+  void Start() {
+    start_ns_ = utils::NowNanos();
+    ops_.store(0, std::memory_order_relaxed);
+    for (Slot &slot : slots_) {
+      slot.ops.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  void CountOp() {
+    std::atomic<uint64_t> &ops = slots_[ThreadSlot()].ops;
+    if (ops.fetch_add(1, std::memory_order_relaxed) % kOpsPerChunk ==
+        kOpsPerChunk - 1) {
+      ops_.fetch_add(kOpsPerChunk, std::memory_order_relaxed);
+    }
+  }
+
+  double Seconds() const { return (utils::NowNanos() - start_ns_) / 1e9; }
+  uint64_t Ops() const { return ops_.load(std::memory_order_relaxed); }
+
+  ///
+  /// Returns the progress in the chosen unit.
+  ///
+  double Progress(bool by_ops) const { return by_ops ? Ops() : Seconds(); }
+
+ private:
+  static const size_t kSlots = 64;  /// Threads beyond share slots
+
+  ///
+  /// Counts of one thread, padded so that no two share a cache line however
+  /// the clock is aligned.
+  ///
+  struct Slot {
+    std::atomic<uint64_t> ops;
+    char padding[128 - sizeof(std::atomic<uint64_t>)];
+  };
+
+  static size_t ThreadSlot() {
+    static std::atomic<size_t> threads(0);
+    static thread_local size_t slot =
+        threads.fetch_add(1, std::memory_order_relaxed) % kSlots;
+    return slot;
+  }
+
+  uint64_t start_ns_;
+  std::atomic<uint64_t> ops_;
+  Slot slots_[kSlots];
+};
+
+}  // namespace ycsbc
+
+#endif  // YCSB_C_WORKLOAD_CLOCK_H_
@@ -9,6 +9,8 @@
 #ifndef YCSB_C_ZIPFIAN_GENERATOR_H_
 #define YCSB_C_ZIPFIAN_GENERATOR_H_
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <cstdint>
@@ -22,19 +24,22 @@ class ZipfianGenerator : public Generator<uint64_t> {
  public:
   constexpr static const double kZipfianConst = 0.99;
   static const uint64_t kMaxNumItems = (UINT64_MAX >> 24);
+  static const uint64_t kExactZetaTerms = 1024;
 
   ZipfianGenerator(uint64_t min, uint64_t max,
                    double zipfian_const = kZipfianConst)
       : num_items_(max - min + 1),
         base_(min),
         theta_(zipfian_const),
+        seq_(0),
+        n_for_zeta_(0),
         zeta_n_(0),
-        n_for_zeta_(0) {
+        eta_(0) {
     assert(num_items_ >= 2 && num_items_ < kMaxNumItems);
     zeta_2_ = Zeta(2, theta_);
     alpha_ = 1.0 / (1.0 - theta_);
+    half_pow_theta_ = std::pow(0.5, theta_);
     RaiseZeta(num_items_);
-    eta_ = Eta();
 
     Next();
   }
@@ -46,22 +51,33 @@ class ZipfianGenerator : public Generator<uint64_t> {
 
   uint64_t Next() { return Next(num_items_); }
 
-  uint64_t Last();
+  uint64_t Last() { return last_value_.load(std::memory_order_relaxed); }
 
  private:
+  ///
+  /// The parameters that depend on the number of items.
+  ///
+  struct State {
+    uint64_t n_for_zeta;
+    double zeta_n;
+    double eta;
+  };
+
+  ///
+  /// Reads a consistent copy of the state. Readers never block or write
+  /// shared memory; they retry only while the state is being raised.
+  ///
+  State LoadState() const;
+
   ///
   /// Compute the zeta constant needed for the distribution.
   /// Remember the number of items, so if it is changed, we can recompute zeta.
+  /// Writers are serialized by mutex_ and publish through the seqlock seq_.
   ///
-  void RaiseZeta(uint64_t num) {
-    assert(num >= n_for_zeta_);
-    zeta_n_ = Zeta(n_for_zeta_, num, theta_, zeta_n_);
-    n_for_zeta_ = num;
-  }
+  void RaiseZeta(uint64_t num);
 
-  double Eta() {
-    return (1 - std::pow(2.0 / num_items_, 1 - theta_)) /
-           (1 - zeta_2_ / zeta_n_);
+  double Eta(uint64_t num, double zeta_n) const {
+    return (1 - std::pow(2.0 / num, 1 - theta_)) / (1 - zeta_2_ / zeta_n);
   }
 
   ///
@@ -70,15 +86,43 @@ class ZipfianGenerator : public Generator<uint64_t> {
   /// Use the zipfian constant as theta. Remember the new number of items
   /// so that, if it is changed, we can recompute zeta.
   ///
+  /// The first kExactZetaTerms terms of the range are summed directly and the
+  /// rest is approximated by the Euler-Maclaurin formula, so the cost is
+  /// constant in the number of items. With the tail starting at 1024 or
+  /// beyond, the approximation error is far below the rounding error of
+  /// summing the terms one by one.
+  ///
   static double Zeta(uint64_t last_num, uint64_t cur_num, double theta,
                      double last_zeta) {
     double zeta = last_zeta;
-    for (uint64_t i = last_num + 1; i <= cur_num; ++i) {
+    uint64_t exact_end = std::min(cur_num, last_num + kExactZetaTerms);
+    for (uint64_t i = last_num + 1; i <= exact_end; ++i) {
       zeta += 1 / std::pow(i, theta);
     }
+    if (exact_end < cur_num) {
+      zeta += ZetaTail(exact_end + 1, cur_num, theta);
+    }
     return zeta;
   }
 
+  ///
+  /// Euler-Maclaurin approximation of the sum of 1 / i^theta for i in
+  /// [first, last], with the correction terms up to the third derivative.
+  ///
+  static double ZetaTail(uint64_t first, uint64_t last, double theta) {
+    double a = first, b = last;
+    double integral = theta == 1.0 ? std::log(b / a)
+                                   : (std::pow(b, 1 - theta) -
+                                      std::pow(a, 1 - theta)) /
+                                         (1 - theta);
+    double f_a = std::pow(a, -theta), f_b = std::pow(b, -theta);
+    double d1_a = -theta * f_a / a, d1_b = -theta * f_b / b;
+    double d3_a = d1_a * (theta + 1) * (theta + 2) / (a * a);
+    double d3_b = d1_b * (theta + 1) * (theta + 2) / (b * b);
+    return integral + (f_a + f_b) / 2 + (d1_b - d1_a) / 12 -
+           (d3_b - d3_a) / 720;
+  }
+
   static double Zeta(uint64_t num, double theta) {
     return Zeta(0, num, theta, 0);
   }
@@ -87,38 +131,65 @@ class ZipfianGenerator : public Generator<uint64_t> {
   uint64_t base_;  /// Min number of items to generate
 
   // Computed parameters for generating the distribution
-  double theta_, zeta_n_, eta_, alpha_, zeta_2_;
-  uint64_t n_for_zeta_;  /// Number of items used to compute zeta_n
-  uint64_t last_value_;
+  double theta_, alpha_, zeta_2_, half_pow_theta_;
+  std::atomic<uint64_t> seq_;         /// Odd while the state below is written
+  std::atomic<uint64_t> n_for_zeta_;  /// Number of items used to compute zeta_n
+  std::atomic<double> zeta_n_, eta_;
   std::mutex mutex_;
+  std::atomic<uint64_t> last_value_;
 };
 
+inline ZipfianGenerator::State ZipfianGenerator::LoadState() const {
+  State state;
+  uint64_t seq;
+  do {
+    seq = seq_.load(std::memory_order_acquire);
+    state.n_for_zeta = n_for_zeta_.load(std::memory_order_relaxed);
+    state.zeta_n = zeta_n_.load(std::memory_order_relaxed);
+    state.eta = eta_.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+  } while ((seq & 1) || seq != seq_.load(std::memory_order_relaxed));
+  return state;
+}
+
+inline void ZipfianGenerator::RaiseZeta(uint64_t num) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t n = n_for_zeta_.load(std::memory_order_relaxed);
+  if (num <= n) return;  // Raised by another thread meanwhile
+  double zeta_n =
+      Zeta(n, num, theta_, zeta_n_.load(std::memory_order_relaxed));
+
+  uint64_t seq = seq_.load(std::memory_order_relaxed);
+  seq_.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  n_for_zeta_.store(num, std::memory_order_relaxed);
+  zeta_n_.store(zeta_n, std::memory_order_relaxed);
+  eta_.store(Eta(num, zeta_n), std::memory_order_relaxed);
+  seq_.store(seq + 2, std::memory_order_release);
+}
+
 inline uint64_t ZipfianGenerator::Next(uint64_t num) {
   assert(num >= 2 && num < kMaxNumItems);
-  std::lock_guard<std::mutex> lock(mutex_);
 
-  if (num > n_for_zeta_) {  // Recompute zeta_n and eta
+  State state = LoadState();
+  if (num > state.n_for_zeta) {  // Recompute zeta_n and eta
     RaiseZeta(num);
-    eta_ = Eta();
+    state = LoadState();
   }
 
   double u = utils::RandomDouble();
-  double uz = u * zeta_n_;
+  double uz = u * state.zeta_n;
+  uint64_t value;
 
   if (uz < 1.0) {
-    return last_value_ = 0;
+    value = base_;
+  } else if (uz < 1.0 + half_pow_theta_) {
+    value = base_ + 1;
+  } else {
+    value = base_ + num * std::pow(state.eta * u - state.eta + 1, alpha_);
   }
-
-  if (uz < 1.0 + std::pow(0.5, theta_)) {
-    return last_value_ = 1;
-  }
-
-  return last_value_ = base_ + num * std::pow(eta_ * u - eta_ + 1, alpha_);
-}
-
-inline uint64_t ZipfianGenerator::Last() {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return last_value_;
+  last_value_.store(value, std::memory_order_relaxed);
+  return value;
 }
 
 }  // namespace ycsbc
@@ -5,20 +5,115 @@
 
 #include "rocksdb.h"
 
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <memory>
+#include <thread>
 
 #include "coding.h"
 
 using namespace std;
 
 namespace ycsbc {
+
+namespace {
+
+inline rocksdb::Slice ToRocksSlice(const Slice &s) {
+  return rocksdb::Slice(s.data(), s.size());
+}
+
+///
+/// Takes a length-prefixed string off the bytes [*p, end).
+/// @return false if the length or the string runs past end.
+///
+bool GetLengthPrefixed(const char **p, const char *end, Slice *s) {
+  if (end - *p < 8) return false;
+  uint64_t size = DecodeFixed64(*p);
+  *p += 8;
+  if (size > static_cast<uint64_t>(end - *p)) return false;
+  *s = Slice(*p, size);
+  *p += size;
+  return true;
+}
+
+}  // namespace
+
 RocksDB::RocksDB(const char *dbfilename, utils::Properties &props)
-    : noResult(0), /*cache_(nullptr),*/ dbstats_(nullptr), write_sync_(false) {
+    : txn_db_(nullptr),
+      optimistic_db_(nullptr),
+      noResult(0),
+      /*cache_(nullptr),*/ dbstats_(nullptr),
+      write_sync_(false),
+      reuse_iterators_(false),
+      id_(NextId()) {
   // set option
   rocksdb::Options options;
   SetOptions(&options, props);
+  reuse_iterators_ = utils::StrToBool(
+      props.GetProperty("rocksdb.reuseiterators", "false"));
+
+  // Each listed table gets a column family with its own options. Without a
+  // list, the single table stays in the default column family.
+  vector<rocksdb::ColumnFamilyDescriptor> column_families;
+  column_families.emplace_back(rocksdb::kDefaultColumnFamilyName, options);
+  SetColumnFamilyOptions(props, &column_families[0].options);
+  if (!props.GetProperty(CoreWorkload::TABLES_PROPERTY).empty()) {
+    for (const string &table : CoreWorkload::TableNames(props)) {
+      rocksdb::ColumnFamilyOptions cf_options = options;
+      SetColumnFamilyOptions(CoreWorkload::TableProperties(props, table),
+                             &cf_options);
+      if (table == rocksdb::kDefaultColumnFamilyName) {
+        column_families[0].options = cf_options;
+      } else {
+        column_families.emplace_back(table, cf_options);
+      }
+    }
+  }
+  // All column families of an existing DB have to be opened
+  vector<string> existing;
+  if (rocksdb::DB::ListColumnFamilies(options, dbfilename, &existing).ok()) {
+    for (const string &name : existing) {
+      bool listed = false;
+      for (auto &cf : column_families) {
+        listed |= cf.name == name;
+      }
+      if (!listed) column_families.emplace_back(name, options);
+    }
+  }
+  options.create_missing_column_families = true;
 
-  rocksdb::Status s = rocksdb::DB::Open(options, dbfilename, &db_);
+  Open(dbfilename, props, options, column_families);
+  for (size_t i = 0; i < cf_handles_.size(); ++i) {
+    tables_[column_families[i].name] = cf_handles_[i];
+  }
+}
+
+void RocksDB::Open(
+    const std::string &dbfilename, const utils::Properties &props,
+    const rocksdb::Options &options,
+    const std::vector<rocksdb::ColumnFamilyDescriptor> &column_families) {
+  // Only transactions of the transaction workload go through the
+  // transaction layer; other writes still pay for its locking or validation
+  string mode = props.GetProperty("rocksdb.transactiondb", "none");
+  rocksdb::Status s;
+  if (mode == "pessimistic") {
+    s = rocksdb::TransactionDB::Open(options, rocksdb::TransactionDBOptions(),
+                                     dbfilename, column_families,
+                                     &cf_handles_, &txn_db_);
+    db_ = txn_db_;
+  } else if (mode == "optimistic") {
+    s = rocksdb::OptimisticTransactionDB::Open(
+        options, dbfilename, column_families, &cf_handles_, &optimistic_db_);
+    // Not a DB itself, unlike TransactionDB; it owns the DB it wraps
+    if (s.ok()) db_ = optimistic_db_->GetBaseDB();
+  } else if (mode == "none") {
+    s = rocksdb::DB::Open(options, dbfilename, column_families, &cf_handles_,
+                          &db_);
+  } else {
+    cerr << "Unknown rocksdb.transactiondb: " << mode << endl;
+    exit(0);
+  }
   if (!s.ok()) {
     cerr << "Can't open rocksdb " << dbfilename << " " << s.ToString() << endl;
     exit(0);
@@ -54,7 +149,7 @@ void RocksDB::SetOptions(rocksdb::Options *options, utils::Properties &props) {
   /*
   //cache
 uint64_t nums = stoi(props.GetProperty(CoreWorkload::RECORD_COUNT_PROPERTY));
-uint32_t key_len = stoi(props.GetProperty(CoreWorkload::KEY_LENGTH));
+uint32_t key_len = stoi(props.GetProperty(CoreWorkload::KEY_LENGTH_PROPERTY));
 uint32_t value_len =
 stoi(props.GetProperty(CoreWorkload::FIELD_LENGTH_PROPERTY));
 
@@ -81,21 +176,76 @@ table_options->filter_policy.reset(rocksdb::NewBloomFilterPolicy(10,false));
   write_sync_ = false;  //主要是写日志，
 }
 
+void RocksDB::SetColumnFamilyOptions(const utils::Properties &props,
+                                     rocksdb::ColumnFamilyOptions *options) {
+  // An options string such as "write_buffer_size=64M;compression=kZSTD"
+  string options_string = props.GetProperty("rocksdb.cfoptions");
+  if (options_string.empty()) return;
+  rocksdb::Status s = rocksdb::GetColumnFamilyOptionsFromString(
+      *options, options_string, options);
+  if (!s.ok()) {
+    cerr << "Bad column family options of table "
+         << props.GetProperty(CoreWorkload::TABLENAME_PROPERTY,
+                              CoreWorkload::TABLENAME_DEFAULT)
+         << ": " << s.ToString() << endl;
+    exit(0);
+  }
+}
+
+void RocksDB::Init() { CurrentSession(); }
+
+uint64_t RocksDB::NextId() {
+  static std::atomic<uint64_t> ids(0);
+  return ids.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+RocksDB::Session *RocksDB::CurrentSession() {
+  // Keyed by id, as a later DB may be allocated where a deleted one was
+  static thread_local uint64_t owner = 0;
+  static thread_local Session *session = nullptr;
+  if (owner == id_) return session;
+
+  std::unique_ptr<Session> created(new Session);
+  created->write_options.sync = write_sync_;
+  // A tailing iterator sees writes made after it was created, so one can
+  // serve every scan of the thread instead of being rebuilt for each
+  created->scan_options.tailing = reuse_iterators_;
+  std::lock_guard<std::mutex> lock(sessions_mutex_);
+  sessions_.push_back(std::move(created));
+  owner = id_;
+  session = sessions_.back().get();
+  return session;
+}
+
+rocksdb::ColumnFamilyHandle *RocksDB::ColumnFamily(const std::string &table) {
+  auto it = tables_.find(table);
+  return it != tables_.end() ? it->second : db_->DefaultColumnFamily();
+}
+
 int RocksDB::Read(const std::string &table, const std::string &key,
                   const std::vector<std::string> *fields,
                   std::vector<KVPair> &result) {
-  string value;
-  rocksdb::Status s = db_->Get(rocksdb::ReadOptions(), key, &value);
-  if (s.ok()) {
-    // printf("value:%lu\n",value.size());
-    DeSerializeValues(value, result);
-    /* printf("get:key:%lu-%s\n",key.size(),key.data());
-    for( auto kv : result) {
-        printf("get field:key:%lu-%s
-    value:%lu-%s\n",kv.first.size(),kv.first.data(),kv.second.size(),kv.second.data());
-    } */
-    return DB::kOK;
+  RecordBuffer record;
+  int status = Read(table, Slice(key), fields, &record);
+  for (const Field &field : record.fields()) {
+    result.emplace_back(field.first.ToString(), field.second.ToString());
   }
+  return status;
+}
+
+int RocksDB::Read(const std::string &table, const Slice &key,
+                  const std::vector<std::string> *fields,
+                  RecordBuffer *result) {
+  Session *session = CurrentSession();
+  // Pinned in the block cache or memtable where possible, instead of copied
+  rocksdb::PinnableSlice &value = session->pinned;
+  rocksdb::Status s = db_->Get(session->read_options, ColumnFamily(table),
+                               ToRocksSlice(key), &value);
+  if (s.ok()) DeSerializeValues(value, result);
+  // Releases the pin, but keeps the buffer values are copied into otherwise
+  value.Reset();
+  if (s.ok()) return DB::kOK;
+  result->Clear();
   if (s.IsNotFound()) {
     noResult++;
     // cerr<<"read not found:"<<noResult<<endl;
@@ -109,36 +259,78 @@ int RocksDB::Read(const std::string &table, const std::string &key,
 int RocksDB::Scan(const std::string &table, const std::string &key, int len,
                   const std::vector<std::string> *fields,
                   std::vector<std::vector<KVPair>> &result) {
-  auto it = db_->NewIterator(rocksdb::ReadOptions());
-  it->Seek(key);
-  std::string val;
-  std::string k;
-  // printf("len:%d\n",len);
+  ScanBuffer records;
+  int status = Scan(table, Slice(key), len, fields, &records);
+  for (size_t i = 0; i < records.size(); ++i) {
+    result.emplace_back();
+    for (const Field &field : records[i].fields()) {
+      result.back().emplace_back(field.first.ToString(),
+                                 field.second.ToString());
+    }
+  }
+  return status;
+}
+
+int RocksDB::Scan(const std::string &table, const Slice &key, int len,
+                  const std::vector<std::string> *fields,
+                  ScanBuffer *result) {
+  result->Clear();
+  Session *session = CurrentSession();
+  rocksdb::ColumnFamilyHandle *cf = ColumnFamily(table);
+  std::unique_ptr<rocksdb::Iterator> scan_iterator;
+  std::unique_ptr<rocksdb::Iterator> &it =
+      reuse_iterators_ ? session->iterators[cf] : scan_iterator;
+  if (!it) it.reset(db_->NewIterator(session->scan_options, cf));
+  it->Seek(ToRocksSlice(key));
   for (int i = 0; i < len && it->Valid(); i++) {
-    k = it->key().ToString();
-    val = it->value().ToString();
-    // printf("i:%d key:%lu value:%lu\n",i,k.size(),val.size());
+    DeSerializeValues(it->value(), result->Add());
     it->Next();
   }
-  delete it;
+  return DB::kOK;
+}
+
+int RocksDB::MultiRead(const std::string &table,
+                       const std::vector<Slice> &keys,
+                       const std::vector<std::string> *fields,
+                       ScanBuffer *result) {
+  result->Clear();
+  Session *session = CurrentSession();
+  session->multiget_cfs.assign(keys.size(), ColumnFamily(table));
+  session->multiget_keys.clear();
+  for (const Slice &key : keys) {
+    session->multiget_keys.push_back(ToRocksSlice(key));
+  }
+  // The keys share one lookup of the current memtables and files
+  std::vector<rocksdb::Status> statuses =
+      db_->MultiGet(session->read_options, session->multiget_cfs,
+                    session->multiget_keys, &session->multiget_values);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    RecordBuffer *record = result->Add();
+    const rocksdb::Status &s = statuses[i];
+    if (s.ok()) {
+      DeSerializeValues(session->multiget_values[i], record);
+    } else if (s.IsNotFound()) {
+      noResult++;
+    } else {
+      cerr << "multiget error: " << s.ToString() << endl;
+      exit(0);
+    }
+  }
   return DB::kOK;
 }
 
 int RocksDB::Insert(const std::string &table, const std::string &key,
                     std::vector<KVPair> &values) {
-  rocksdb::Status s;
-  string value;
-  SerializeValues(values, value);
-  /* printf("put:key:%lu-%s\n",key.size(),key.data());
-  for( auto kv : values) {
-      printf("put field:key:%lu-%s
-  value:%lu-%s\n",kv.first.size(),kv.first.data(),kv.second.size(),kv.second.data());
-  } */
-  rocksdb::WriteOptions write_options = rocksdb::WriteOptions();
-  if (write_sync_) {
-    write_options.sync = true;
-  }
-  s = db_->Put(write_options, key, value);
+  std::vector<Field> fields(values.begin(), values.end());
+  return Insert(table, Slice(key), fields);
+}
+
+int RocksDB::Insert(const std::string &table, const Slice &key,
+                    const std::vector<Field> &values) {
+  Session *session = CurrentSession();
+  SerializeValues(values, &session->value);
+  rocksdb::Status s = db_->Put(session->write_options, ColumnFamily(table),
+                               ToRocksSlice(key), session->value);
   if (!s.ok()) {
     cerr << "insert error\n" << endl;
     exit(0);
@@ -152,13 +344,14 @@ int RocksDB::Update(const std::string &table, const std::string &key,
   return Insert(table, key, values);
 }
 
+int RocksDB::Update(const std::string &table, const Slice &key,
+                    const std::vector<Field> &values) {
+  return Insert(table, key, values);
+}
+
 int RocksDB::Delete(const std::string &table, const std::string &key) {
-  rocksdb::Status s;
-  rocksdb::WriteOptions write_options = rocksdb::WriteOptions();
-  if (write_sync_) {
-    write_options.sync = true;
-  }
-  s = db_->Delete(write_options, key);
+  rocksdb::Status s =
+      db_->Delete(CurrentSession()->write_options, ColumnFamily(table), key);
   if (!s.ok()) {
     cerr << "Delete error\n" << endl;
     exit(0);
@@ -166,11 +359,108 @@ int RocksDB::Delete(const std::string &table, const std::string &key) {
   return DB::kOK;
 }
 
+int RocksDB::Transaction(const std::string &table,
+                         const std::vector<std::string> &keys,
+                         const std::vector<ValueBuffer> &values,
+                         ScanBuffer *results, uint64_t *commit_ns) {
+  Session *session = CurrentSession();
+  rocksdb::ColumnFamilyHandle *cf = ColumnFamily(table);
+  const rocksdb::WriteOptions &write_options = session->write_options;
+  results->Clear();
+  string &value = session->value;
+  rocksdb::Status s;
+
+  if (!txn_db_ && !optimistic_db_) {
+    // Reads are not isolated from other writers, but the writes are applied
+    // atomically in one batch, whose write is the commit
+    rocksdb::WriteBatch &batch = session->batch;
+    batch.Clear();
+    for (size_t i = 0; i < keys.size(); ++i) {
+      RecordBuffer *record = results->Add();
+      s = db_->Get(session->read_options, cf, keys[i], &value);
+      if (s.ok()) {
+        DeSerializeValues(value, record);
+      } else if (!s.IsNotFound()) {
+        cerr << "transaction read error: " << s.ToString() << endl;
+        exit(0);
+      }
+      SerializeValues(values[i].fields(), &value);
+      batch.Put(cf, keys[i], value);
+    }
+    uint64_t start = utils::NowNanos();
+    s = db_->Write(write_options, &batch);
+    *commit_ns = utils::NowNanos() - start;
+    if (!s.ok()) {
+      cerr << "transaction write error: " << s.ToString() << endl;
+      exit(0);
+    }
+    return DB::kOK;
+  }
+
+  // The transaction of the last call is reinitialized rather than reallocated
+  rocksdb::Transaction *old_txn = session->txn.release();
+  session->txn.reset(
+      txn_db_ ? txn_db_->BeginTransaction(
+                    write_options, rocksdb::TransactionOptions(), old_txn)
+              : optimistic_db_->BeginTransaction(
+                    write_options, rocksdb::OptimisticTransactionOptions(),
+                    old_txn));
+  rocksdb::Transaction *txn = session->txn.get();
+  for (size_t i = 0; i < keys.size() && (s.ok() || s.IsNotFound()); ++i) {
+    RecordBuffer *record = results->Add();
+    // Locks the key, or remembers it to validate at commit if optimistic
+    s = txn->GetForUpdate(session->read_options, cf, keys[i], &value);
+    if (s.ok()) DeSerializeValues(value, record);
+    if (s.ok() || s.IsNotFound()) {
+      SerializeValues(values[i].fields(), &value);
+      s = txn->Put(cf, keys[i], value);
+    }
+  }
+  if (s.ok()) {
+    uint64_t start = utils::NowNanos();
+    s = txn->Commit();
+    *commit_ns = utils::NowNanos() - start;
+    if (s.ok()) return DB::kOK;
+  }
+  txn->Rollback();
+  // Busy on a write conflict or deadlock, TimedOut on a lock wait, and
+  // TryAgain if optimistic validation found too little memtable history
+  if (s.IsBusy() || s.IsTimedOut() || s.IsTryAgain()) {
+    return DB::kErrorConflict;
+  }
+  cerr << "transaction error: " << s.ToString() << endl;
+  exit(0);
+}
+
+void RocksDB::WaitForBalance() {
+  static const char *const kPendingWork[] = {
+      "rocksdb.mem-table-flush-pending", "rocksdb.num-running-flushes",
+      "rocksdb.compaction-pending", "rocksdb.num-running-compactions"};
+  while (true) {
+    uint64_t pending = 0;
+    for (auto cf : cf_handles_) {
+      for (auto property : kPendingWork) {
+        uint64_t value = 0;
+        db_->GetIntProperty(cf, property, &value);
+        pending += value;
+      }
+    }
+    if (pending == 0) break;
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+  }
+}
+
 void RocksDB::PrintStats() {
   if (noResult) cout << "read not found:" << noResult << endl;
   string stats;
   db_->GetProperty("rocksdb.stats", &stats);
   cout << stats << endl;
+  for (auto cf : cf_handles_) {
+    if (cf->GetName() == rocksdb::kDefaultColumnFamilyName) continue;
+    db_->GetProperty(cf, "rocksdb.cfstats", &stats);
+    cout << "** Column family " << cf->GetName() << " **" << endl;
+    cout << stats << endl;
+  }
 
   if (dbstats_.get() != nullptr) {
     fprintf(stdout, "STATISTICS:\n%s\n", dbstats_->ToString().c_str());
@@ -178,46 +468,67 @@ void RocksDB::PrintStats() {
 }
 
 RocksDB::~RocksDB() {
-  delete db_;
+  // Iterators and transactions must not outlive the DB
+  sessions_.clear();
+  // DB::DestroyColumnFamilyHandle is newer than the RocksDB built against
+  for (auto cf : cf_handles_) {
+    delete cf;
+  }
+  if (optimistic_db_) {
+    delete optimistic_db_;
+  } else {
+    delete db_;
+  }
   /*if (cache_.get() != nullptr) {
        this will leak, but we're shutting down so nobody cares
       cache_->DisownData();
   }*/
 }
 
-void RocksDB::SerializeValues(std::vector<KVPair> &kvs, std::string &value) {
-  value.clear();
-  PutFixed64(&value, kvs.size());
-  for (unsigned int i = 0; i < kvs.size(); i++) {
-    PutFixed64(&value, kvs[i].first.size());
-    value.append(kvs[i].first);
-    PutFixed64(&value, kvs[i].second.size());
-    value.append(kvs[i].second);
+void RocksDB::SerializeValues(const std::vector<Field> &fields,
+                              std::string *value) {
+  size_t size = 8;
+  for (const Field &field : fields) {
+    size += 16 + field.first.size() + field.second.size();
+  }
+  value->clear();
+  value->reserve(size);
+  PutFixed64(value, fields.size());
+  for (const Field &field : fields) {
+    PutFixed64(value, field.first.size());
+    value->append(field.first.data(), field.first.size());
+    PutFixed64(value, field.second.size());
+    value->append(field.second.data(), field.second.size());
   }
 }
 
-void RocksDB::DeSerializeValues(std::string &value, std::vector<KVPair> &kvs) {
-  uint64_t offset = 0;
-  uint64_t kv_num = 0;
-  uint64_t key_size = 0;
-  uint64_t value_size = 0;
-
-  kv_num = DecodeFixed64(value.c_str());
-  offset += 8;
-  for (unsigned int i = 0; i < kv_num; i++) {
-    ycsbc::DB::KVPair pair;
-    key_size = DecodeFixed64(value.c_str() + offset);
-    offset += 8;
-
-    pair.first.assign(value.c_str() + offset, key_size);
-    offset += key_size;
-
-    value_size = DecodeFixed64(value.c_str() + offset);
-    offset += 8;
-
-    pair.second.assign(value.c_str() + offset, value_size);
-    offset += value_size;
-    kvs.push_back(pair);
+bool RocksDB::DeSerializeValues(const rocksdb::Slice &value,
+                                RecordBuffer *record) {
+  // Copied once into the record, whose fields then point into the copy
+  record->SetData(value.data(), value.size());
+  const char *p = record->data();
+  const char *end = p + record->data_size();
+  if (end - p < 8) {
+    record->SetCorrupted();
+    return false;
+  }
+  uint64_t kv_num = DecodeFixed64(p);
+  p += 8;
+  // Every field takes at least 16 bytes, so a bad count runs out of bytes
+  for (uint64_t i = 0; i < kv_num; i++) {
+    Slice name, field_value;
+    if (!GetLengthPrefixed(&p, end, &name) ||
+        !GetLengthPrefixed(&p, end, &field_value)) {
+      record->SetCorrupted();
+      return false;
+    }
+    record->AddField(name, field_value);
   }
+  if (p != end) {
+    record->SetCorrupted();
+    return false;
+  }
+  return true;
 }
+
 }  // namespace ycsbc
@@ -2,14 +2,21 @@
 #define YCSB_C_ROCKS_DB_H_
 
 #include <rocksdb/cache.h>
+#include <rocksdb/convenience.h>
 #include <rocksdb/db.h>
 #include <rocksdb/filter_policy.h>
 #include <rocksdb/options.h>
 #include <rocksdb/table.h>
+#include <rocksdb/utilities/optimistic_transaction_db.h>
+#include <rocksdb/utilities/transaction_db.h>
+#include <rocksdb/write_batch.h>
 
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "core_workload.h"
 #include "db.h"
@@ -23,6 +30,8 @@ class RocksDB : public DB {
  public:
   RocksDB(const char *dbfilename, utils::Properties &props);
 
+  void Init();
+
   int Read(const std::string &table, const std::string &key,
            const std::vector<std::string> *fields, std::vector<KVPair> &result);
 
@@ -38,20 +47,94 @@ class RocksDB : public DB {
 
   int Delete(const std::string &table, const std::string &key);
 
+  int Read(const std::string &table, const Slice &key,
+           const std::vector<std::string> *fields, RecordBuffer *result);
+
+  int Scan(const std::string &table, const Slice &key, int len,
+           const std::vector<std::string> *fields, ScanBuffer *result);
+
+  int MultiRead(const std::string &table, const std::vector<Slice> &keys,
+                const std::vector<std::string> *fields, ScanBuffer *result);
+
+  int Update(const std::string &table, const Slice &key,
+             const std::vector<Field> &values);
+
+  int Insert(const std::string &table, const Slice &key,
+             const std::vector<Field> &values);
+
+  int Transaction(const std::string &table,
+                  const std::vector<std::string> &keys,
+                  const std::vector<ValueBuffer> &values,
+                  ScanBuffer *results, uint64_t *commit_ns);
+
+  void WaitForBalance();
+
   void PrintStats();
 
   ~RocksDB();
 
  private:
+  ///
+  /// State of one client thread, reused by every call it makes so that
+  /// operations build no options, buffers or iterators of their own.
+  /// Sessions are owned by the DB, which releases their iterators before it
+  /// closes.
+  ///
+  struct Session {
+    rocksdb::ReadOptions read_options;
+    rocksdb::ReadOptions scan_options;
+    rocksdb::WriteOptions write_options;
+    std::string value;              /// Serialization buffer
+    rocksdb::PinnableSlice pinned;  /// Value of the last Get
+    rocksdb::WriteBatch batch;
+    std::unique_ptr<rocksdb::Transaction> txn;  /// Reused by BeginTransaction
+    std::vector<rocksdb::ColumnFamilyHandle *> multiget_cfs;
+    std::vector<rocksdb::Slice> multiget_keys;
+    std::vector<std::string> multiget_values;
+    // Scan iterators by column family, if they are reused
+    std::unordered_map<rocksdb::ColumnFamilyHandle *,
+                       std::unique_ptr<rocksdb::Iterator>>
+        iterators;
+  };
+
   rocksdb::DB *db_;
+  // At most one is set, by rocksdb.transactiondb. txn_db_ is also db_, while
+  // optimistic_db_ owns db_, its base DB
+  rocksdb::TransactionDB *txn_db_;
+  rocksdb::OptimisticTransactionDB *optimistic_db_;
+  std::vector<rocksdb::ColumnFamilyHandle *> cf_handles_;
+  // Column family of each table; other tables use the default one
+  std::unordered_map<std::string, rocksdb::ColumnFamilyHandle *> tables_;
   unsigned noResult;
   // std::shared_ptr<rocksdb::Cache> cache_;
   std::shared_ptr<rocksdb::Statistics> dbstats_;
   bool write_sync_;
+  bool reuse_iterators_;
+  const uint64_t id_;  /// Unique to this DB, unlike its address
+  std::mutex sessions_mutex_;
+  std::vector<std::unique_ptr<Session>> sessions_;
+
+  ///
+  /// Returns the session of the calling thread, which is created on its
+  /// first call.
+  ///
+  Session *CurrentSession();
+  static uint64_t NextId();
+  void Open(const std::string &dbfilename, const utils::Properties &props,
+            const rocksdb::Options &options,
+            const std::vector<rocksdb::ColumnFamilyDescriptor> &families);
 
   void SetOptions(rocksdb::Options *options, utils::Properties &props);
-  void SerializeValues(std::vector<KVPair> &kvs, std::string &value);
-  void DeSerializeValues(std::string &value, std::vector<KVPair> &kvs);
+  void SetColumnFamilyOptions(const utils::Properties &props,
+                              rocksdb::ColumnFamilyOptions *options);
+  rocksdb::ColumnFamilyHandle *ColumnFamily(const std::string &table);
+  void SerializeValues(const std::vector<Field> &fields, std::string *value);
+  ///
+  /// Decodes a stored value into record. A value whose lengths do not add up
+  /// to its size, as when corrupted or truncated, marks the record corrupted.
+  /// @return false if the value could not be decoded.
+  ///
+  bool DeSerializeValues(const rocksdb::Slice &value, RecordBuffer *record);
 };
 
 }  // namespace ycsbc
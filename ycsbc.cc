@@ -6,17 +6,30 @@
 //  Copyright (c) 2014 Jinglei Ren <jinglei@ren.systems>.
 //
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
-#include <future>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <random>
 #include <string>
 #include <vector>
 
 #include "client.h"
 #include "core_workload.h"
 #include "db_factory.h"
+#include "measurements.h"
+#include "op_stream.h"
+#include "pacer.h"
+#include "status_reporter.h"
+#include "thread_placement.h"
 #include "timer.h"
+#include "trace_workload.h"
 #include "utils.h"
+#include "worker_pool.h"
 
 using namespace std;
 
@@ -26,96 +39,516 @@ string ParseCommandLine(int argc, const char *argv[], utils::Properties &props);
 void Init(utils::Properties &props);
 void PrintInfo(utils::Properties &props);
 
-int DelegateClient(ycsbc::DB *db, ycsbc::CoreWorkload *wl, const int num_ops,
-                   bool is_loading) {
-  db->Init();
-  ycsbc::Client client(*db, *wl);
+const int64_t kMaxOpsPerClaim = 1024;
+
+///
+/// Settings and shared state of one phase (load or run), common to all
+/// client threads.
+///
+struct Phase {
+  explicit Phase(bool loading)
+      : is_loading(loading),
+        target_ops(0),
+        poisson(false),
+        max_execution_sec(0),
+        warmup_sec(0),
+        deadline_ns(0),
+        warmup_end_ns(0),
+        warmup_ops(0),
+        total_ops(0),
+        num_threads(1),
+        replay(NULL),
+        trace(NULL),
+        start_ns(0),
+        next_op(0),
+        measure_start_ns(0),
+        verified(0),
+        corrupted(0),
+        stale(0),
+        transactions(0),
+        committed(0),
+        conflicts(0),
+        aborted(0),
+        retries(0) {}
+
+  bool is_loading;
+  double target_ops;       /// Per-thread target rate, 0 for closed-loop
+  bool poisson;            /// Poisson instead of fixed-interval arrivals
+  double max_execution_sec;
+  double warmup_sec;
+  uint64_t deadline_ns;    /// No operation is issued after it, 0 if unbounded
+  uint64_t warmup_end_ns;  /// Warm-up by time, 0 if not
+  uint64_t warmup_ops;     /// Warm-up by operations over all threads, 0 if not
+  int64_t total_ops;
+  int num_threads;
+  const ycsbc::OpStreamReader *replay;  /// Pre-generated operations, if any
+  ycsbc::TraceWorkload *trace;          /// Recorded trace, if any
+  uint64_t start_ns;                    /// When the threads were released
+  atomic<int64_t> next_op;            /// Index of the next unclaimed operation
+  atomic<uint64_t> measure_start_ns;  /// End of the warm-up, 0 until then
+  atomic<uint64_t> verified;          /// Records checked in verify mode
+  atomic<uint64_t> corrupted;
+  atomic<uint64_t> stale;
+  atomic<uint64_t> transactions;  /// Multi-key transactions after warm-up
+  atomic<uint64_t> committed;
+  atomic<uint64_t> conflicts;
+  atomic<uint64_t> aborted;
+  atomic<uint64_t> retries;
+};
+
+///
+/// Latencies of one client thread. The warm-up snapshots hold what had been
+/// recorded when the warm-up ended and are subtracted from the final result.
+///
+struct ClientMeasurements {
+  ycsbc::Measurements latency;
+  ycsbc::Measurements intended_latency;  /// Target-rate mode only
+  ycsbc::Measurements warmup;
+  ycsbc::Measurements intended_warmup;
+};
+
+///
+/// Claims the next chunk [begin, end) of the operations of the phase.
+/// Chunks shrink as the phase nears its end, so that threads finish together
+/// no matter how unevenly fast they are.
+///
+bool ClaimOps(Phase *phase, int64_t *begin, int64_t *end) {
+  int64_t remaining =
+      phase->total_ops - phase->next_op.load(memory_order_relaxed);
+  if (remaining <= 0) return false;
+  int64_t chunk = remaining / (4 * phase->num_threads);
+  chunk = max<int64_t>(1, min<int64_t>(chunk, kMaxOpsPerClaim));
+  *begin = phase->next_op.fetch_add(chunk, memory_order_relaxed);
+  if (*begin >= phase->total_ops) return false;
+  *end = min(*begin + chunk, phase->total_ops);
+  return true;
+}
+
+bool WarmingUp(Phase *phase, int64_t op) {
+  if (phase->measure_start_ns.load(memory_order_relaxed)) return false;
+  uint64_t now = utils::NowNanos();
+  uint64_t start = now;
+  if (phase->warmup_end_ns) {
+    if (now < phase->warmup_end_ns) return true;
+    start = phase->warmup_end_ns;
+  } else if (static_cast<uint64_t>(op) < phase->warmup_ops) {
+    return true;
+  }
+  uint64_t expected = 0;
+  phase->measure_start_ns.compare_exchange_strong(expected, start);
+  return false;
+}
+
+int DelegateClient(ycsbc::DB *db, ycsbc::CoreWorkload *wl, Phase *phase,
+                   ClientMeasurements *measurements) {
+  const bool trace_paced = phase->trace && phase->trace->timestamp_pacing();
+  ycsbc::Client client(
+      *db, *wl, &measurements->latency,
+      phase->target_ops > 0 || trace_paced ? &measurements->intended_latency
+                                           : NULL);
+  unique_ptr<ycsbc::Pacer> pacer;
+  if (phase->target_ops > 0) {
+    pacer.reset(
+        new ycsbc::Pacer(phase->target_ops, phase->poisson, random_device()()));
+  }
+  bool warming_up = phase->warmup_end_ns || phase->warmup_ops;
+  // Transactions counted when the warm-up ended, like the latencies
+  ycsbc::Client::TransactionCounts warmup_txns;
+  // Trace records are taken a batch per lock of the ring buffer, except when
+  // paced, where a batch would serialize records due at about the same time
+  const size_t trace_batch = trace_paced ? 1 : 64;
+  vector<ycsbc::TraceRecord> records;
+  size_t next_record = 0, num_records = 0;
   int oks = 0;
-  int next_report_ = 0;
-
-  for (int i = 0; i < num_ops; ++i) {
-    if (i >= next_report_) {
-      if (next_report_ < 1000)
-        next_report_ += 100;
-      else if (next_report_ < 5000)
-        next_report_ += 500;
-      else if (next_report_ < 10000)
-        next_report_ += 1000;
-      else if (next_report_ < 50000)
-        next_report_ += 5000;
-      else if (next_report_ < 100000)
-        next_report_ += 10000;
-      else if (next_report_ < 500000)
-        next_report_ += 50000;
-      else
-        next_report_ += 100000;
-      fprintf(stderr, "... finished %d ops%30s\r", i, "");
-      fflush(stderr);
-    }
-    if (is_loading) {
-      oks += client.DoInsert();
-    } else {
-      oks += client.DoTransaction();
+  int64_t begin, end;
+
+  while (ClaimOps(phase, &begin, &end)) {
+    for (int64_t i = begin; i < end; ++i) {
+      if (phase->deadline_ns && utils::NowNanos() >= phase->deadline_ns) {
+        // Let the other threads stop too
+        phase->next_op.store(phase->total_ops, memory_order_relaxed);
+        break;
+      }
+      if (warming_up && !WarmingUp(phase, i)) {
+        warming_up = false;
+        measurements->warmup.Merge(measurements->latency);
+        measurements->intended_warmup.Merge(measurements->intended_latency);
+        warmup_txns = client.transaction_counts();
+      }
+      if (pacer) {
+        client.SetIntendedStart(pacer->Next());
+      }
+      if (phase->is_loading) {
+        oks += client.DoInsert();
+      } else if (phase->replay) {
+        oks += client.DoOperation((*phase->replay)[i]);
+      } else if (phase->trace) {
+        if (next_record == num_records) {
+          num_records = phase->trace->NextBatch(&records, trace_batch);
+          next_record = 0;
+        }
+        if (num_records == 0) {
+          phase->next_op.store(phase->total_ops, memory_order_relaxed);
+          break;
+        }
+        const ycsbc::TraceRecord &record = records[next_record++];
+        if (trace_paced) {
+          uint64_t intended =
+              phase->start_ns + phase->trace->OffsetNanos(record);
+          ycsbc::Pacer::WaitUntil(intended);
+          client.SetIntendedStart(intended);
+        }
+        oks += client.DoTraceOperation(record);
+      } else {
+        oks += client.DoTransaction();
+      }
     }
   }
+  if (warming_up) {
+    // The phase ended before its warm-up did
+    measurements->warmup.Merge(measurements->latency);
+    measurements->intended_warmup.Merge(measurements->intended_latency);
+    warmup_txns = client.transaction_counts();
+  }
+  const ycsbc::Client::VerifyCounts &verify = client.verify_counts();
+  phase->verified += verify.records;
+  phase->corrupted += verify.corrupted;
+  phase->stale += verify.stale;
+  const ycsbc::Client::TransactionCounts &txns = client.transaction_counts();
+  phase->transactions += txns.transactions - warmup_txns.transactions;
+  phase->committed += txns.committed - warmup_txns.committed;
+  phase->conflicts += txns.conflicts - warmup_txns.conflicts;
+  phase->aborted += txns.aborted - warmup_txns.aborted;
+  phase->retries += txns.retries - warmup_txns.retries;
   return oks;
 }
 
+///
+/// Merges the per-thread latencies recorded after the warm-up.
+///
+void MergeMeasurements(
+    const vector<unique_ptr<ClientMeasurements>> &measurements, bool intended,
+    ycsbc::Measurements *total) {
+  ycsbc::Measurements warmup;
+  for (auto &m : measurements) {
+    total->Merge(intended ? m->intended_latency : m->latency);
+    warmup.Merge(intended ? m->intended_warmup : m->warmup);
+  }
+  if (warmup.Count()) total->Subtract(warmup);
+}
+
+void PrintMeasurements(const char *phase, const ycsbc::Measurements &total) {
+  printf("---- %s latency ----\n", phase);
+  printf("%s", total.Summary().c_str());
+  fflush(stdout);
+}
+
+///
+/// Runs one phase on all client threads and returns the number of successful
+/// operations. The clock starts when the threads are released together and
+/// stops when the last one finishes; the duration returned excludes the
+/// warm-up.
+///
+int ExecutePhase(ycsbc::DB *db, ycsbc::CoreWorkload *wl, int64_t total_ops,
+                 Phase *phase, ycsbc::WorkerPool *pool,
+                 const vector<unique_ptr<ClientMeasurements>> &measurements,
+                 ycsbc::StatusReporter *reporter, const string &name,
+                 double *duration) {
+  const int num_threads = pool->size();
+  for (auto &m : measurements) {
+    m->latency.Reset();
+    m->intended_latency.Reset();
+    m->warmup.Reset();
+    m->intended_warmup.Reset();
+  }
+
+  phase->total_ops = total_ops;
+  phase->num_threads = num_threads;
+  vector<int> oks(num_threads, 0);
+  pool->Prepare([&](int i) {
+    oks[i] = DelegateClient(db, wl, phase, measurements[i].get());
+  });
+
+  uint64_t start_ns = utils::NowNanos();
+  phase->start_ns = start_ns;
+  if (phase->max_execution_sec > 0) {
+    phase->deadline_ns = start_ns + phase->max_execution_sec * 1e9;
+  }
+  if (phase->warmup_sec > 0) {
+    phase->warmup_end_ns = start_ns + phase->warmup_sec * 1e9;
+  }
+  reporter->Start(name);
+  wl->StartClock();
+  pool->Release();
+  pool->Wait();
+  reporter->Stop();
+
+  uint64_t measure_start_ns = phase->measure_start_ns.load();
+  if (!measure_start_ns) measure_start_ns = pool->release_ns();
+  *duration = (pool->LastEndNanos() - measure_start_ns) / 1e9;
+
+  printf("---- %s threads: start skew %.3f ms, end skew %.3f ms ----\n",
+         name.c_str(), pool->StartSkewNanos() / 1e6,
+         pool->EndSkewNanos() / 1e6);
+  fflush(stdout);
+
+  int sum = 0;
+  for (int n : oks) {
+    sum += n;
+  }
+  return sum;
+}
+
+void Load(ycsbc::DB *db, const utils::Properties &props,
+          ycsbc::WorkerPool *pool,
+          const vector<unique_ptr<ClientMeasurements>> &measurements,
+          ycsbc::StatusReporter *reporter, ycsbc::VersionTables *versions) {
+  ycsbc::CoreWorkload wl;
+  wl.SetVersionTables(versions);
+  wl.Init(props);
+
+  Phase load(true);
+  double duration;
+  int sum = ExecutePhase(db, &wl, wl.load_count(), &load, pool, measurements,
+                         reporter, "load", &duration);
+  cerr << "# Loading records:\t" << sum << endl;
+
+  ycsbc::Measurements total;
+  MergeMeasurements(measurements, false, &total);
+  PrintMeasurements("load", total);
+  db->PrintStats();
+}
+
+///
+/// Runs the transactions of a spec. Phases share the DB, so carried holds
+/// what a phase leaves for the next, like the records it inserted: it is
+/// applied on top of spec_props, and updated once the phase is over. The
+/// versions verify mode tracks are carried in versions.
+///
+void Run(ycsbc::DB *db, const utils::Properties &spec_props,
+         const string &spec, ycsbc::WorkerPool *pool,
+         const vector<unique_ptr<ClientMeasurements>> &measurements,
+         ycsbc::StatusReporter *reporter, utils::Properties *carried,
+         ycsbc::VersionTables *versions) {
+  utils::Properties props = spec_props;
+  for (const auto &property : carried->properties()) {
+    props.SetProperty(property.first, property.second);
+  }
+  if (utils::StrToBool(props["dbwaitforbalance"])) {
+    cerr << "# Waiting for background work of the DB" << endl;
+    db->WaitForBalance();
+  }
+
+  ycsbc::CoreWorkload wl;
+  wl.SetVersionTables(versions);
+  wl.Init(props);
+
+  // Target-rate mode: transactions run open-loop and are additionally
+  // measured from their intended start times
+  const int num_threads = pool->size();
+  const double target = stod(props["target"]);
+  Phase run(false);
+  run.target_ops = target / num_threads;
+  run.poisson = props["targetarrival"] == "poisson";
+  run.max_execution_sec = stod(props["maxexecutiontime"]);
+  run.warmup_sec = stod(props["warmuptime"]);
+  run.warmup_ops = stoull(props["warmupops"]);
+
+  int64_t total_ops =
+      stoll(props[ycsbc::CoreWorkload::OPERATION_COUNT_PROPERTY]);
+  if (total_ops == 0 && run.max_execution_sec > 0) {
+    // Bounded by time only
+    total_ops = numeric_limits<int64_t>::max() / 2;
+  }
+  unique_ptr<ycsbc::OpStreamReader> replay;
+  if (!props["replayfile"].empty()) {
+    try {
+      replay.reset(new ycsbc::OpStreamReader(props["replayfile"]));
+      // Checked once here rather than on the client threads, which also
+      // reads the stream in before the phase starts
+      for (uint64_t i = 0; i < replay->size(); ++i) {
+        try {
+          wl.CheckOpRecord((*replay)[i]);
+        } catch (const utils::Exception &e) {
+          throw utils::Exception(props["replayfile"] + ": record " +
+                                 to_string(i) + ": " + e.what());
+        }
+      }
+    } catch (const utils::Exception &e) {
+      cout << e.what() << endl;
+      exit(0);
+    }
+    run.replay = replay.get();
+    total_ops = replay->size();
+  }
+  // A trace runs until it is exhausted (or the time is up)
+  unique_ptr<ycsbc::TraceWorkload> trace;
+  if (!props["tracefile"].empty()) {
+    trace.reset(new ycsbc::TraceWorkload);
+    try {
+      trace->Init(props);
+    } catch (const utils::Exception &e) {
+      cout << e.what() << endl;
+      exit(0);
+    }
+    run.trace = trace.get();
+    run.target_ops = 0;
+    total_ops = numeric_limits<int64_t>::max() / 2;
+  }
+  double duration;
+  ExecutePhase(db, &wl, total_ops, &run, pool, measurements, reporter, "run",
+               &duration);
+  if (trace && !trace->error().empty()) {
+    cerr << "# Trace replay stopped early: " << trace->error() << endl;
+  }
+  wl.SaveRecordCounts(carried);
+  if (wl.verify()) {
+    cerr << "# Verified records:\t" << run.verified << "\tcorrupted: "
+         << run.corrupted << "\tstale: " << run.stale << endl;
+  }
+  if (run.transactions) {
+    uint64_t attempts = run.transactions + run.retries;
+    cerr << "# Transactions:\t" << run.transactions << "\tcommitted: "
+         << run.committed << "\tconflicts: " << run.conflicts << " ("
+         << 100.0 * run.conflicts / attempts << "% of attempts)"
+         << "\taborted: " << run.aborted << "\tretries: " << run.retries
+         << endl;
+  }
+
+  ycsbc::Measurements total;
+  MergeMeasurements(measurements, false, &total);
+  cerr << "# Transaction throughput (KTPS)" << endl;
+  cerr << props["dbname"] << '\t' << spec << '\t' << num_threads << '\t';
+  cerr << total.Count() / duration / 1000 << endl;
+  PrintMeasurements(("run " + spec).c_str(), total);
+  if (target > 0 || (trace && trace->timestamp_pacing())) {
+    ycsbc::Measurements intended_total;
+    MergeMeasurements(measurements, true, &intended_total);
+    PrintMeasurements(("run " + spec + " (from intended start)").c_str(),
+                      intended_total);
+  }
+  db->PrintStats();
+}
+
+///
+/// Writes the operations of the run phase of the spec to an operation stream,
+/// to be replayed later without drawing them on the client threads.
+///
+void Generate(const utils::Properties &props, const string &path) {
+  ycsbc::CoreWorkload wl;
+  wl.Init(props);
+  wl.CheckForOpStream();
+
+  int64_t total_ops =
+      stoll(props[ycsbc::CoreWorkload::OPERATION_COUNT_PROPERTY]);
+  ycsbc::OpStreamWriter writer(path);
+  wl.StartClock();
+  for (int64_t i = 0; i < total_ops; ++i) {
+    writer.Append(wl.NextOpRecord());
+  }
+  writer.Close();
+  cerr << "# Generated operations:\t" << writer.count() << endl;
+}
+
 int main(const int argc, const char *argv[]) {
   utils::Properties props;
   Init(props);
   string file_name = ParseCommandLine(argc, argv, props);
 
+  if (!props["generatefile"].empty()) {
+    try {
+      Generate(props, props["generatefile"]);
+    } catch (const utils::Exception &e) {
+      cout << e.what() << endl;
+      exit(0);
+    }
+    return 0;
+  }
+
   ycsbc::DB *db = ycsbc::DBFactory::CreateDB(props);
   if (!db) {
     cout << "Unknown database name " << props["dbname"] << endl;
     exit(0);
   }
 
-  ycsbc::CoreWorkload wl;
-  wl.Init(props);
-
   const int num_threads = stoi(props.GetProperty("threadcount", "1"));
 
-  // Loads data
-  vector<future<int>> actual_ops;
-  int total_ops = stoi(props[ycsbc::CoreWorkload::RECORD_COUNT_PROPERTY]);
-  for (int i = 0; i < num_threads; ++i) {
-    actual_ops.emplace_back(async(launch::async, DelegateClient, db, &wl,
-                                  total_ops / num_threads, true));
+  // Client threads are started, placed and attached to the DB once for all
+  // phases. Their measurements are allocated by the threads themselves, so
+  // that the pages are local to them, and each seeds its own random generator.
+  unique_ptr<ycsbc::ThreadPlacement> placement;
+  try {
+    placement.reset(new ycsbc::ThreadPlacement(
+        props["threadaffinity"], utils::StrToBool(props["threadlocalmemory"])));
+  } catch (const utils::Exception &e) {
+    cout << e.what() << endl;
+    exit(0);
   }
-  assert((int)actual_ops.size() == num_threads);
+  vector<unique_ptr<ClientMeasurements>> measurements(num_threads);
+  const uint64_t seed = stoull(props["randomseed"]);
+  ycsbc::WorkerPool pool(num_threads, [&](int i) {
+    placement->Place(i);
+    utils::ThreadRandom().Seed(seed * num_threads + i);
+    measurements[i].reset(new ClientMeasurements);
+    db->Init();
+  });
 
-  int sum = 0;
-  for (auto &n : actual_ops) {
-    assert(n.valid());
-    sum += n.get();
+  vector<ycsbc::Measurements *> thread_measurements;
+  for (auto &m : measurements) {
+    thread_measurements.push_back(&m->latency);
   }
-  cerr << "# Loading records:\t" << sum << endl;
+  ycsbc::StatusReporter reporter(thread_measurements,
+                                 stod(props["reportinterval"]));
 
-  // Peforms transactions
-  actual_ops.clear();
-  total_ops = stoi(props[ycsbc::CoreWorkload::OPERATION_COUNT_PROPERTY]);
-  utils::Timer<double> timer;
-  timer.Start();
-  for (int i = 0; i < num_threads; ++i) {
-    actual_ops.emplace_back(async(launch::async, DelegateClient, db, &wl,
-                                  total_ops / num_threads, false));
+  // Further specs run against the same DB, each on top of the base
+  // properties. They are read up front, so that a mistyped spec fails before
+  // the long phases.
+  vector<pair<string, utils::Properties>> more_runs;
+  stringstream more_run_list(props["morerun"]);
+  string spec;
+  while (getline(more_run_list, spec, ',')) {
+    if (spec.empty()) continue;
+    ifstream input(spec);
+    if (!input.is_open()) {
+      cout << "Cannot open -morerun spec " << spec << endl;
+      exit(0);
+    }
+    utils::Properties more_props = props;
+    // A replayed stream or trace belongs to the spec of -run
+    more_props.SetProperty("replayfile", "");
+    more_props.SetProperty("tracefile", "");
+    try {
+      more_props.Load(input);
+    } catch (const utils::Exception &e) {
+      cout << spec << ": " << e.what() << endl;
+      exit(0);
+    }
+    more_runs.emplace_back(spec, more_props);
   }
-  assert((int)actual_ops.size() == num_threads);
 
-  sum = 0;
-  for (auto &n : actual_ops) {
-    assert(n.valid());
-    sum += n.get();
+  bool load = utils::StrToBool(props["load"]);
+  bool run = utils::StrToBool(props["run"]);
+  if (!load && !run && more_runs.empty()) {
+    // Neither phase asked for: load and run the spec in one go
+    load = run = true;
+  }
+
+  ycsbc::VersionTables versions;
+  if (load) {
+    Load(db, props, &pool, measurements, &reporter, &versions);
+  }
+  utils::Properties carried;
+  if (run) {
+    Run(db, props, file_name, &pool, measurements, &reporter, &carried,
+        &versions);
+  }
+  for (const auto &more_run : more_runs) {
+    Run(db, more_run.second, more_run.first, &pool, measurements, &reporter,
+        &carried, &versions);
   }
-  double duration = timer.End();
-  cerr << "# Transaction throughput (KTPS)" << endl;
-  cerr << props["dbname"] << '\t' << file_name << '\t' << num_threads << '\t';
-  cerr << total_ops / duration / 1000 << endl;
 
-  db->PrintStats();
   db->Close();
+  delete db;
 }
 
 string ParseCommandLine(int argc, const char *argv[],
@@ -233,7 +666,57 @@ string ParseCommandLine(int argc, const char *argv[],
         UsageMessage(argv[0]);
         exit(0);
       }
-      props.SetProperty("morerun", argv[argindex]);
+      string more_runs = props["morerun"];
+      if (!more_runs.empty()) more_runs.append(",");
+      props.SetProperty("morerun", more_runs.append(argv[argindex]));
+      argindex++;
+    } else if (strcmp(argv[argindex], "-reportinterval") == 0) {
+      argindex++;
+      if (argindex >= argc) {
+        UsageMessage(argv[0]);
+        exit(0);
+      }
+      props.SetProperty("reportinterval", argv[argindex]);
+      argindex++;
+    } else if (strcmp(argv[argindex], "-affinity") == 0) {
+      argindex++;
+      if (argindex >= argc) {
+        UsageMessage(argv[0]);
+        exit(0);
+      }
+      props.SetProperty("threadaffinity", argv[argindex]);
+      argindex++;
+    } else if (strcmp(argv[argindex], "-generate") == 0) {
+      argindex++;
+      if (argindex >= argc) {
+        UsageMessage(argv[0]);
+        exit(0);
+      }
+      props.SetProperty("generatefile", argv[argindex]);
+      argindex++;
+    } else if (strcmp(argv[argindex], "-replay") == 0) {
+      argindex++;
+      if (argindex >= argc) {
+        UsageMessage(argv[0]);
+        exit(0);
+      }
+      props.SetProperty("replayfile", argv[argindex]);
+      argindex++;
+    } else if (strcmp(argv[argindex], "-trace") == 0) {
+      argindex++;
+      if (argindex >= argc) {
+        UsageMessage(argv[0]);
+        exit(0);
+      }
+      props.SetProperty("tracefile", argv[argindex]);
+      argindex++;
+    } else if (strcmp(argv[argindex], "-target") == 0) {
+      argindex++;
+      if (argindex >= argc) {
+        UsageMessage(argv[0]);
+        exit(0);
+      }
+      props.SetProperty("target", argv[argindex]);
       argindex++;
     } else {
       cout << "Unknown option '" << argv[argindex] << "'" << endl;
@@ -261,6 +744,54 @@ void UsageMessage(const char *command) {
   cout << "                   be specified, and will be processed in the order "
           "specified"
        << endl;
+  cout << "  -dbpath path: directory of the DB (default: depends on the DB)"
+       << endl;
+  cout << "  -load true|false: load recordcount records into the DB" << endl;
+  cout << "  -run true|false: run the transactions of the spec against the DB"
+       << endl;
+  cout << "                   (without either, the spec is loaded and run)"
+       << endl;
+  cout << "  -morerun propertyfile: run another spec against the same DB "
+          "afterwards;"
+       << endl;
+  cout << "                         may be repeated or given as a "
+          "comma-separated list"
+       << endl;
+  cout << "  -dbwaitforbalance true|false: wait for background work of the DB "
+          "to finish"
+       << endl;
+  cout << "                                before each run (default: false)"
+       << endl;
+  cout << "  -affinity none|numa|cpulist: pin client threads to CPUs, spread "
+          "over NUMA"
+       << endl;
+  cout << "                               nodes or to the given list, e.g. "
+          "0-7,16-23"
+       << endl;
+  cout << "  -reportinterval s: print throughput and latency of the last s "
+          "seconds"
+       << endl;
+  cout << "                     while a phase runs, 0 to disable (default: 10)"
+       << endl;
+  cout << "  -target n: issue transactions open-loop at n ops/sec in total "
+          "(default: 0,"
+       << endl;
+  cout << "             closed-loop); set targetarrival=poisson for Poisson "
+          "arrivals"
+       << endl;
+  cout << "  -generate file: write the transactions of the spec to file and "
+          "exit"
+       << endl;
+  cout << "  -replay file: run the transactions written by -generate instead "
+          "of drawing"
+       << endl;
+  cout << "                them (only the run of the -P spec)" << endl;
+  cout << "  -trace file: run a recorded trace instead of the transactions of "
+          "the spec;"
+       << endl;
+  cout << "               set tracepacing=timestamp to issue them at their "
+          "recorded times"
+       << endl;
 }
 
 inline bool StrStartWith(const char *str, const char *pre) {
@@ -277,6 +808,18 @@ void Init(utils::Properties &props) {
   props.SetProperty("dbstatistics", "false");
   props.SetProperty("dbwaitforbalance", "false");
   props.SetProperty("morerun", "");
+  props.SetProperty("reportinterval", "10");
+  props.SetProperty("target", "0");
+  props.SetProperty("targetarrival", "fixed");
+  props.SetProperty("maxexecutiontime", "0");
+  props.SetProperty("warmuptime", "0");
+  props.SetProperty("warmupops", "0");
+  props.SetProperty("threadaffinity", "none");
+  props.SetProperty("threadlocalmemory", "false");
+  props.SetProperty("randomseed", "0");
+  props.SetProperty("generatefile", "");
+  props.SetProperty("replayfile", "");
+  props.SetProperty("tracefile", "");
 }
 
 void PrintInfo(utils::Properties &props) {